@@ -0,0 +1,775 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/resource.h>
+#include "raster.h"
+#include "x11_colours.h"
+#include "xpm.h"
+#include "xpm_lazy.h"
+#include "xpm_parse.h"
+#include "xpm_stream.h"
+#include "xpm_writer.h"
+
+#if XPM_STATS
+// xpm_stats.cpp already counts every allocation when statistics are built in.
+static std::size_t allocation_count() {
+  return xpm_allocation_count();
+}
+
+static std::size_t allocated_bytes() {
+  return xpm_allocated_bytes();
+}
+#else
+// Every allocation the library makes goes through these, so each measured
+// call can report how many it made.
+static std::atomic<std::size_t> allocation_total(0);
+static std::atomic<std::size_t> allocated_byte_total(0);
+
+void* operator new(std::size_t size) {
+  allocation_total.fetch_add(1, std::memory_order_relaxed);
+  allocated_byte_total.fetch_add(size, std::memory_order_relaxed);
+
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+// Over-aligned requests, such as the parse arena's, come through here.
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  const auto align = (std::size_t)alignment;
+
+  allocation_total.fetch_add(1, std::memory_order_relaxed);
+  allocated_byte_total.fetch_add(size, std::memory_order_relaxed);
+
+  if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align))
+    return p;
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+static std::size_t allocation_count() {
+  return allocation_total;
+}
+
+static std::size_t allocated_bytes() {
+  return allocated_byte_total;
+}
+#endif
+
+struct XpmSpec {
+  int width;
+  int height;
+  int colour_count;
+  int chars_per_pixel;
+  bool named_colours;
+  bool crlf;
+};
+
+static std::uint64_t next_random(std::uint64_t& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+
+  return state;
+}
+
+// The colour_count distinct keys of spec's image, each chars_per_pixel long.
+static std::string generate_keys(const XpmSpec& spec) {
+  const std::size_t cpp = spec.chars_per_pixel;
+  const std::size_t key_char_count = xpm_key_chars.size();
+  std::string keys;
+
+  keys.reserve(spec.colour_count * cpp);
+
+  for (auto i = 0; i < spec.colour_count; i++)
+    for (std::size_t c = 0, n = i; c < cpp; c++, n /= key_char_count)
+      keys.push_back(xpm_key_chars[n % key_char_count]);
+
+  return keys;
+}
+
+// Builds a synthetic image as XPM2 or XPM3 text with random pixels drawn
+// from colour_count distinct keys.
+static std::string generate_xpm(const XpmSpec& spec, bool xpm3) {
+  const std::string_view eol = spec.crlf ? "\r\n" : "\n";
+  const std::string_view open = xpm3 ? "\"" : "";
+  const std::string_view close = xpm3 ? "\"," : "";
+  const std::string_view last_close = xpm3 ? "\"" : "";
+  const std::size_t cpp = spec.chars_per_pixel;
+  const std::string keys = generate_keys(spec);
+  std::string result;
+
+  result.reserve((std::size_t)spec.width * spec.height * cpp +
+    spec.colour_count * (cpp + 24) + (std::size_t)spec.height * 8 + 64);
+
+  if (xpm3) {
+    result += "/* XPM */";
+    result += eol;
+    result += "static char* bench_xpm[] = {";
+  }
+
+  else
+    result += "! XPM2";
+
+  result += eol;
+  result += open;
+  result += std::to_string(spec.width) + ' ' + std::to_string(spec.height) +
+    ' ' + std::to_string(spec.colour_count) + ' ' + std::to_string(cpp);
+
+  result += close;
+  result += eol;
+
+  std::uint64_t random_state = 0x9e3779b97f4a7c15;
+  const std::size_t x11_colour_count = std::size(x11_colours);
+
+  for (auto i = 0; i < spec.colour_count; i++) {
+    const std::uint64_t random = next_random(random_state);
+
+    result += open;
+    result.append(keys, i * cpp, cpp);
+    result += " c ";
+
+    if (spec.named_colours)
+      result += x11_colours[random % x11_colour_count].name;
+
+    else {
+      char hex[8];
+
+      std::snprintf(hex, sizeof(hex), "#%06X",
+        (unsigned int)(random & 0xffffff));
+
+      result += hex;
+    }
+
+    result += close;
+    result += eol;
+  }
+
+  for (auto r = 0; r < spec.height; r++) {
+    result += open;
+
+    for (auto c = 0; c < spec.width; c++)
+      result.append(keys,
+        next_random(random_state) % spec.colour_count * cpp, cpp);
+
+    result += r + 1 < spec.height ? close : last_close;
+    result += eol;
+  }
+
+  if (xpm3)
+    result += "};";
+
+  result += eol;
+
+  return result;
+}
+
+// Builds count small XPM2 images, three in ten of them corrupted in one of
+// the ways a batch job over untrusted input meets them: cut short, with a
+// colour that does not parse or with a pixel key that is not defined.
+static std::vector<std::string> generate_batch(std::size_t count) {
+  const XpmSpec spec = {32, 32, 16, 1, false, false};
+  const std::string xpm2 = generate_xpm(spec, false);
+  std::vector<std::string> batch;
+  std::uint64_t random_state = 0x2545f4914f6cdd1d;
+
+  batch.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    std::string& file = batch.emplace_back(xpm2);
+    const std::uint64_t random = next_random(random_state);
+    std::size_t pos = 0;
+
+    switch (i % 10) {
+    case 0:
+      file.resize(random % (file.size() * 9 / 10));
+
+      break;
+
+    case 1:
+      for (auto n = random % spec.colour_count + 1; n; n--)
+        pos = file.find(" c #", pos) + 4;
+
+      file[pos] = 'g';
+
+      break;
+
+    case 2:
+      pos = file.size() / 2 + random % (file.size() / 2);
+
+      // '!' is not a key character.
+      file[file[pos] == '\n' ? pos - 1 : pos] = '!';
+
+      break;
+    }
+  }
+
+  return batch;
+}
+
+// The tokenizer ParseXpm2 used before it walked the input in place, kept to
+// measure against: splits s on delim into owned strings, skipping empties.
+static std::vector<std::string> split_string(std::string_view s,
+  const char delim)
+{
+  auto last_delim_pos = std::string::npos;
+  std::vector<std::string> result;
+
+  for (std::string_view::size_type i = 0; i < s.size(); i++)
+    if (s[i] == delim) {
+      if (last_delim_pos == std::string::npos) {
+        if (i)
+          result.push_back((std::string)s.substr(0, i));
+      }
+
+      else
+        if (i - last_delim_pos > 1)
+          result.push_back((std::string)s.substr(last_delim_pos + 1,
+            i - last_delim_pos - 1));
+
+      last_delim_pos = i;
+    }
+
+    else if (i == s.size() - 1)
+      result.push_back((std::string)s.substr(last_delim_pos + 1));
+
+  return result;
+}
+
+// Tokenizes an XPM2 file the old way: copies it, turns every '\r' into '\n',
+// splits it into owned lines and splits the values and colour lines into
+// owned tokens. Returns the token count.
+static std::size_t tokenize_by_splitting(std::string_view xpm2,
+  int colour_count)
+{
+  std::string contents(xpm2);
+
+  std::replace(contents.begin(), contents.end(), '\r', '\n');
+
+  std::vector<std::string> lines = split_string(contents, '\n');
+  std::size_t token_count = 0;
+
+  std::replace(lines[1].begin(), lines[1].end(), '\t', ' ');
+
+  for (auto i = 1; i < 2 + colour_count; i++)
+    token_count += split_string(lines[i], ' ').size();
+
+  return token_count;
+}
+
+// Tokenizes the same lines the way the parser does now, as views yielded by
+// one forward pass. Returns the token count.
+static std::size_t tokenize_in_place(std::string_view xpm2, int colour_count)
+{
+  Xpm2Lines lines(xpm2);
+  std::string_view line;
+  std::size_t token_count = 0;
+
+  lines.next(line);
+
+  for (auto i = 0; i < 1 + colour_count && lines.next(line); i++)
+    while (!next_token(line, " \t").empty())
+      token_count++;
+
+  // The pixel rows are walked but not split, as the old tokenizer only split
+  // them into lines.
+  while (lines.next(line))
+    ;
+
+  return token_count;
+}
+
+struct Measurement {
+  double seconds = 0;
+  std::size_t allocations = 0;
+  std::size_t allocated_bytes = 0;
+  long peak_rss_kib = 0;
+};
+
+// Lowers Linux's peak resident set size to the current one, so the next
+// peak_rss_kib gives the peak of what ran since. Elsewhere it stays the
+// peak of the whole process.
+static void reset_peak_rss() {
+  std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+// ru_maxrss cannot be reset, and exiting worker threads raise it again, so
+// Linux's VmHWM is read where there is one.
+static long peak_rss_kib() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0)
+      return std::atol(line.c_str() + 6);
+  }
+
+  rusage usage {};
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_maxrss;
+}
+
+// Repeats run until min_seconds have passed, at least once, and keeps the
+// fastest time and the peak resident set size while it ran.
+template <typename Run>
+static Measurement measure(Run run, double min_seconds) {
+  Measurement best;
+  double total_seconds = 0;
+
+  reset_peak_rss();
+
+  for (auto iterations = 0; !iterations ||
+    (iterations < 1000 && total_seconds < min_seconds); iterations++)
+  {
+    const std::size_t allocations_before = allocation_count();
+    const std::size_t bytes_before = allocated_bytes();
+    const auto start = std::chrono::steady_clock::now();
+
+    run();
+
+    const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+    if (!iterations || elapsed.count() < best.seconds)
+      best.seconds = elapsed.count();
+
+    best.allocations = allocation_count() - allocations_before;
+    best.allocated_bytes = allocated_bytes() - bytes_before;
+    total_seconds += elapsed.count();
+  }
+
+  best.peak_rss_kib = peak_rss_kib();
+
+  return best;
+}
+
+static void report(std::string_view case_name, std::string_view operation,
+  const Measurement& measurement, std::size_t bytes, std::size_t pixels)
+{
+  std::printf("%-24.*s %-10.*s %10.1f %10.1f %10zu %12zu %10.1f\n",
+    (int)case_name.size(), case_name.data(),
+    (int)operation.size(), operation.data(),
+    bytes / measurement.seconds / 1e6, pixels / measurement.seconds / 1e6,
+    measurement.allocations, measurement.allocated_bytes,
+    measurement.peak_rss_kib / 1024.0);
+
+  std::fflush(stdout);
+}
+
+struct BenchCase {
+  std::string name;
+  XpmSpec spec;
+};
+
+// Each axis is varied on its own around a 1024x1024, 256 colour, 2 char
+// base image, since the full cross product would take hours.
+static std::vector<BenchCase> bench_cases(bool full) {
+  const XpmSpec base = {1024, 1024, 256, 2, false, false};
+  std::vector<BenchCase> cases;
+
+  auto add = [&cases](std::string name, XpmSpec spec) {
+    spec.chars_per_pixel = std::max(spec.chars_per_pixel,
+      xpm_min_chars_per_pixel(spec.colour_count));
+
+    cases.push_back({std::move(name), spec});
+  };
+
+  std::vector<int> sizes = {16, 256, 2048};
+  std::vector<int> colour_counts = {2, 256, 65536};
+
+  if (full) {
+    sizes.push_back(16384);
+    colour_counts.push_back(1 << 20);
+  }
+
+  for (auto size : sizes) {
+    XpmSpec spec = base;
+
+    spec.width = spec.height = size;
+    add("size=" + std::to_string(size), spec);
+  }
+
+  for (auto colour_count : colour_counts) {
+    XpmSpec spec = base;
+
+    spec.colour_count = colour_count;
+    add("colours=" + std::to_string(colour_count), spec);
+  }
+
+  for (auto chars_per_pixel = 1; chars_per_pixel <= 6; chars_per_pixel++) {
+    XpmSpec spec = base;
+
+    spec.colour_count = 64;
+    spec.chars_per_pixel = chars_per_pixel;
+    add("cpp=" + std::to_string(chars_per_pixel), spec);
+  }
+
+  XpmSpec hex = base;
+  XpmSpec named = base;
+
+  hex.colour_count = named.colour_count = 4096;
+  named.named_colours = true;
+  add("colours=4096,hex", hex);
+  add("colours=4096,x11", named);
+
+  XpmSpec crlf = base;
+
+  crlf.crlf = true;
+  add("eol=crlf", crlf);
+
+  return cases;
+}
+
+static void print_usage() {
+  std::cerr <<
+    "usage: xpm-bench [options]\n"
+    "\n"
+    "options:\n"
+    "  --full         add the 16384x16384 and 1M colour cases\n"
+    "  --filter S     only run cases whose name contains S\n"
+    "  --threads N    parse with N threads (0: one per core, default: 1)\n"
+    "  --min-time S   repeat each measurement for S seconds (default: 0.5)\n"
+    "  --write DIR    save the generated files to DIR instead of measuring\n";
+}
+
+int main(int argc, char** argv) {
+  bool full = false;
+  std::string filter;
+  XpmParseOptions parse_options;
+  double min_seconds = 0.5;
+  std::filesystem::path write_dir;
+
+  for (auto i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    const bool has_value = i + 1 < argc;
+
+    if (arg == "--full")
+      full = true;
+
+    else if (arg == "--filter" && has_value)
+      filter = argv[++i];
+
+    else if (arg == "--threads" && has_value)
+      parse_options.thread_count = std::atoi(argv[++i]);
+
+    else if (arg == "--min-time" && has_value)
+      min_seconds = std::atof(argv[++i]);
+
+    else if (arg == "--write" && has_value)
+      write_dir = argv[++i];
+
+    else {
+      print_usage();
+
+      return 2;
+    }
+  }
+
+  if (write_dir.empty()) {
+    std::printf("%-24s %-10s %10s %10s %10s %12s %10s\n", "case",
+      "operation", "MB/s", "Mpixels/s", "allocs", "alloc bytes", "peak MiB");
+  }
+
+  for (const auto& bench_case : bench_cases(full)) {
+    if (bench_case.name.find(filter) == std::string::npos)
+      continue;
+
+    const XpmSpec& spec = bench_case.spec;
+    const std::string xpm2 = generate_xpm(spec, false);
+    const std::string xpm3 = generate_xpm(spec, true);
+    const std::size_t pixels = (std::size_t)spec.width * spec.height;
+
+    if (!write_dir.empty()) {
+      std::string file_name = bench_case.name;
+
+      std::replace(file_name.begin(), file_name.end(), '=', '-');
+      std::replace(file_name.begin(), file_name.end(), ',', '-');
+      std::ofstream(write_dir / (file_name + ".xpm2"), std::ios::binary) <<
+        xpm2;
+
+      std::ofstream(write_dir / (file_name + ".xpm3"), std::ios::binary) <<
+        xpm3;
+
+      continue;
+    }
+
+    Xpm xpm;
+
+    const Measurement parse2 = measure([&]() {
+      Xpm().ParseXpm2(xpm2, parse_options);
+    }, min_seconds);
+
+    const Measurement parse3 = measure([&]() {
+      Xpm().ParseXpm3(xpm3, parse_options);
+    }, min_seconds);
+
+    // Feeds the XPM2 text in 64 KiB chunks, as a reader of a pipe would.
+    const Measurement stream = measure([&]() {
+      XpmStreamDecoder decoder([](int, const std::uint32_t*) {});
+
+      for (std::size_t pos = 0; pos < xpm2.size(); pos += 0x10000)
+        decoder.Feed(std::string_view(xpm2).substr(pos, 0x10000));
+
+      if (!decoder.Finish()) {
+        std::cerr << bench_case.name << ": " << decoder.error().message() <<
+          '\n';
+
+        std::exit(EXIT_FAILURE);
+      }
+    }, min_seconds);
+
+    report(bench_case.name, "parse2", parse2, xpm2.size(), pixels);
+    report(bench_case.name, "stream2", stream, xpm2.size(), pixels);
+    report(bench_case.name, "parse3", parse3, xpm3.size(), pixels);
+
+    // The two formats hold the same pixels, so their parse speeds compare
+    // directly; above 1 XPM3 is the faster.
+    std::printf("%-24.*s %-10s %9.2fx\n", (int)bench_case.name.size(),
+      bench_case.name.data(), "parse3/2", parse2.seconds / parse3.seconds);
+
+    std::size_t split_tokens = 0;
+    std::size_t tokens = 0;
+
+    const Measurement split = measure([&]() {
+      split_tokens = tokenize_by_splitting(xpm2, spec.colour_count);
+    }, min_seconds);
+
+    const Measurement tokenize = measure([&]() {
+      tokens = tokenize_in_place(xpm2, spec.colour_count);
+    }, min_seconds);
+
+    if (tokens != split_tokens) {
+      std::cerr << bench_case.name << ": the tokenizers disagree\n";
+
+      return EXIT_FAILURE;
+    }
+
+    report(bench_case.name, "split", split, xpm2.size(), pixels);
+    report(bench_case.name, "tokenize", tokenize, xpm2.size(), pixels);
+
+    // How many times faster the single pass is than copying and splitting.
+    std::printf("%-24.*s %-10s %9.2fx\n", (int)bench_case.name.size(),
+      bench_case.name.data(), "split/tok", split.seconds / tokenize.seconds);
+
+    auto discard = [](std::string_view) {};
+
+    report(bench_case.name, "2to3", measure([&]() {
+      Xpm::Xpm2ToXpm3(L"bench", xpm2, discard);
+    }, min_seconds), xpm2.size(), pixels);
+
+    report(bench_case.name, "3to2", measure([&]() {
+      Xpm::Xpm3ToXpm2(xpm3, discard);
+    }, min_seconds), xpm3.size(), pixels);
+
+    // Row decoding on its own, through the decoder the parser picks and
+    // through the generic one over a hashed table, as it would be without
+    // the one- and two-character specializations and their direct table.
+    if (spec.chars_per_pixel <= 2) {
+      const std::string keys = generate_keys(spec);
+      KeyTable key_table(spec.chars_per_pixel, spec.colour_count);
+
+      KeyTable hashed_key_table(spec.chars_per_pixel, spec.colour_count,
+        std::pmr::get_default_resource(), false);
+
+      std::vector<std::string_view> rows;
+      std::vector<std::uint32_t> indices(spec.width);
+
+      for (auto i = 0; i < spec.colour_count; i++) {
+        const std::string_view key = std::string_view(keys).substr(
+          (std::size_t)i * spec.chars_per_pixel, spec.chars_per_pixel);
+
+        key_table.insert(key, i);
+        hashed_key_table.insert(key, i);
+      }
+
+      // The rows are the last height lines of the XPM2 text.
+      std::size_t pos = 0;
+
+      for (auto i = 0; i < 2 + spec.colour_count; i++)
+        pos = xpm2.find('\n', pos) + 1;
+
+      for (auto r = 0; r < spec.height; r++) {
+        rows.push_back(std::string_view(xpm2).substr(pos,
+          (std::size_t)spec.width * spec.chars_per_pixel));
+
+        pos = xpm2.find('\n', pos) + 1;
+      }
+
+      auto decode_rows = [&](XpmRowDecoder<std::uint32_t> decode_row,
+        const KeyTable& table)
+      {
+        return measure([&]() {
+          for (const auto row : rows)
+            decode_row(row, table, indices.data(), spec.width);
+        }, min_seconds);
+      };
+
+      const Measurement specialized = decode_rows(
+        xpm_row_decoder<std::uint32_t>(spec.chars_per_pixel), key_table);
+
+      const Measurement generic = decode_rows(decode_xpm_row<0, std::uint32_t>,
+        hashed_key_table);
+      const std::size_t row_bytes = pixels * spec.chars_per_pixel;
+
+      report(bench_case.name, "decode", specialized, row_bytes, pixels);
+      report(bench_case.name, "decode<0>", generic, row_bytes, pixels);
+
+      // How many times faster the specialized decoder is.
+      std::printf("%-24.*s %-10s %9.2fx\n", (int)bench_case.name.size(),
+        bench_case.name.data(), "decode/0", generic.seconds /
+        specialized.seconds);
+    }
+
+    xpm.ParseXpm2(xpm2, parse_options);
+
+    const Measurement bulk = measure([&]() {
+      rasterize(xpm, PixelFormat::rgba32);
+    }, min_seconds);
+
+    // The way the viewer drew before rasterize: one Xpm::pixel lookup and
+    // pack per pixel.
+    const Measurement per_pixel = measure([&]() {
+      std::vector<std::uint32_t> out;
+
+      out.reserve(pixels);
+
+      for (auto y = 0; y < xpm.height(); y++)
+        for (auto x = 0; x < xpm.width(); x++)
+          out.push_back(pack_pixel(xpm.pixel(x, y), PixelFormat::rgba32));
+    }, min_seconds);
+
+    report(bench_case.name, "rasterize", bulk, pixels * sizeof(std::uint32_t),
+      pixels);
+
+    report(bench_case.name, "pixel()", per_pixel,
+      pixels * sizeof(std::uint32_t), pixels);
+
+    // How many times faster the bulk path fills the same buffer.
+    std::printf("%-24.*s %-10s %9.2fx\n", (int)bench_case.name.size(),
+      bench_case.name.data(), "raster/px", per_pixel.seconds / bulk.seconds);
+  }
+
+  // Compares reporting the failures of a mostly small, partly corrupt batch
+  // by exception and by result.
+  const std::string batch_name = "batch,30%-corrupt";
+
+  if (write_dir.empty() && batch_name.find(filter) != std::string::npos) {
+    const std::vector<std::string> batch = generate_batch(1000);
+    std::size_t bytes = 0;
+    std::size_t failures = 0;
+
+    for (const auto& file : batch)
+      bytes += file.size();
+
+    report(batch_name, "throw", measure([&]() {
+      for (const auto& file : batch)
+        try {
+          Xpm().ParseXpm2(file, parse_options);
+        }
+
+        catch (const std::exception&) {
+          failures++;
+        }
+    }, min_seconds), bytes, batch.size() * 32 * 32);
+
+    report(batch_name, "try", measure([&]() {
+      for (const auto& file : batch)
+        failures += !Xpm::TryParseXpm2(file, parse_options);
+    }, min_seconds), bytes, batch.size() * 32 * 32);
+  }
+
+  // Opens a file through its sidecar: first parsing it and saving one, then
+  // reopening from it. The reopened decoder must read the same pixels as
+  // Xpm, and a file touched since must be parsed again.
+  const std::string reopen_name = "reopen";
+
+  if (write_dir.empty() && reopen_name.find(filter) != std::string::npos) {
+    const XpmSpec spec = {1024, 1024, 4096, 2, false, false};
+    const std::string xpm2 = generate_xpm(spec, false);
+    const std::size_t pixels = (std::size_t)spec.width * spec.height;
+    const std::filesystem::path file_path =
+      std::filesystem::temp_directory_path() / "xpm-bench-reopen.xpm2";
+
+    const std::filesystem::path index_path = xpm_index_path(file_path);
+    Xpm xpm;
+    std::vector<std::uint32_t> decoded(pixels);
+    bool from_index = false;
+
+    std::ofstream(file_path, std::ios::binary) << xpm2;
+    xpm.ParseXpm2(xpm2);
+
+    const Measurement open = measure([&]() {
+      std::filesystem::remove(index_path);
+      from_index |= XpmLazyDecoder().OpenIndexed(file_path, xpm2, false);
+    }, min_seconds);
+
+    bool reopened = true;
+
+    const Measurement reopen = measure([&]() {
+      reopened &= XpmLazyDecoder().OpenIndexed(file_path, xpm2, false);
+    }, min_seconds);
+
+    report(reopen_name, "open", open, xpm2.size(), pixels);
+    report(reopen_name, "reopen", reopen, xpm2.size(), pixels);
+
+    XpmLazyDecoder decoder;
+
+    reopened &= decoder.OpenIndexed(file_path, xpm2, false);
+    decoder.ReadRegion(0, 0, spec.width, spec.height, decoded.data(),
+      spec.width);
+
+    for (std::size_t i = 0; i < pixels && reopened; i++)
+      reopened = decoded[i] == xpm.index((int)(i % spec.width),
+        (int)(i / spec.width));
+
+    std::filesystem::last_write_time(file_path,
+      std::filesystem::last_write_time(file_path) + std::chrono::seconds(1));
+
+    const bool stale_used = XpmLazyDecoder().OpenIndexed(file_path, xpm2,
+      false);
+
+    std::filesystem::remove(index_path);
+    std::filesystem::remove(file_path);
+
+    if (from_index || !reopened || stale_used) {
+      std::cerr << reopen_name << ": the sidecar was " << (from_index ?
+        "used before it was saved" : !reopened ? "not used or misread" :
+        "used for a touched file") << '\n';
+
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,859 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mapped_file.h"
+#include "parallel.h"
+#include "raster.h"
+#include "xpm.h"
+#include "xpm_compiled.h"
+#include "xpm_lazy.h"
+#include "xpm_validate.h"
+#include "xpm_writer.h"
+
+enum class Command
+{
+  validate,
+  convert,
+  render,
+  index,
+  thumbnail,
+};
+
+enum class OutputFormat
+{
+  xpm2,
+  xpm3,
+  xpmc,
+  rgba,
+  ppm,
+  pam,
+};
+
+struct Options {
+  Command command = Command::validate;
+  OutputFormat format = OutputFormat::xpm2;
+  std::filesystem::path output_dir;
+  int thread_count = 0;
+  std::uintmax_t max_memory = (std::uintmax_t)1 << 30;
+  bool quiet = false;
+  bool stats = false;
+  bool rle = false;
+  bool compact = false;
+  int thumbnail_size = 128;
+  std::vector<std::filesystem::path> file_paths;
+};
+
+static void print_usage() {
+  std::cerr <<
+    "usage: xpm-cli validate [options] FILE...\n"
+    "       xpm-cli convert --to xpm2|xpm3|xpmc [options] FILE...\n"
+    "       xpm-cli render --to rgba|ppm|pam [options] FILE...\n"
+    "       xpm-cli index [options] FILE...\n"
+    "       xpm-cli thumbnail --to rgba|ppm|pam [options] FILE...\n"
+    "\n"
+    "A directory given as a FILE stands for the .xpm, .xpm2, .xpm3 and .xpmc\n"
+    "files directly inside it.\n"
+    "\n"
+    "options:\n"
+    "  -o DIR         write outputs to DIR, creating it if needed, instead of\n"
+    "                 beside each input\n"
+    "  -l, --list F   read more paths from F, one per line (- for stdin)\n"
+    "  -j N           process N files at once (default: one per core)\n"
+    "  -m, --max-memory MB\n"
+    "                 bound the input held in flight (default: 1024)\n"
+    "  -q             only report failures\n"
+    "  --rle          run-length encode xpmc output\n"
+    "  --compact      write xpm2 or xpm3 from the decoded image, dropping\n"
+    "                 unused colours and re-keying with the fewest chars\n"
+    "  -s, --size N   fit thumbnails within N by N pixels (default: 128)\n"
+    "  --stats        report each parse's statistics as a JSON line (needs a\n"
+    "                 build with -DXPM_STATS=1)\n";
+}
+
+static void usage_error(std::string_view msg) {
+  throw std::invalid_argument((std::string)msg);
+}
+
+// Directories are expanded to the XPM files directly inside them, in name
+// order so that output is repeatable.
+static void add_path(const std::filesystem::path& path,
+  std::vector<std::filesystem::path>& file_paths)
+{
+  std::error_code ec;
+
+  if (!std::filesystem::is_directory(path, ec)) {
+    file_paths.push_back(path);
+
+    return;
+  }
+
+  std::vector<std::filesystem::path> entries;
+
+  for (const auto& entry : std::filesystem::directory_iterator(path)) {
+    const std::string extension = entry.path().extension().string();
+
+    if (entry.is_regular_file(ec) && (extension == ".xpm" ||
+      extension == ".xpm2" || extension == ".xpm3" || extension == ".xpmc"))
+    {
+      entries.push_back(entry.path());
+    }
+  }
+
+  std::sort(entries.begin(), entries.end());
+  file_paths.insert(file_paths.end(), entries.begin(), entries.end());
+}
+
+// Listed paths are expanded as those given on the command line are.
+static void read_file_list(std::istream& in,
+  std::vector<std::filesystem::path>& file_paths)
+{
+  std::string line;
+
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+
+    if (!line.empty())
+      add_path(line, file_paths);
+  }
+}
+
+static Options parse_options(int argc, char** argv) {
+  Options options;
+
+  if (argc < 2)
+    usage_error("no command given");
+
+  const std::string_view command = argv[1];
+
+  if (command == "validate")
+    options.command = Command::validate;
+
+  else if (command == "convert")
+    options.command = Command::convert;
+
+  else if (command == "render")
+    options.command = Command::render;
+
+  else if (command == "index")
+    options.command = Command::index;
+
+  else if (command == "thumbnail")
+    options.command = Command::thumbnail;
+
+  else
+    usage_error("unknown command");
+
+  bool has_format = false;
+
+  for (auto i = 2; i < argc; i++) {
+    const std::string_view arg = argv[i];
+
+    auto value = [&i, argc, argv]() -> std::string_view {
+      if (i + 1 >= argc)
+        usage_error("missing option value");
+
+      return argv[++i];
+    };
+
+    if (arg == "--to") {
+      const std::string_view format = value();
+
+      if (format == "xpm2")
+        options.format = OutputFormat::xpm2;
+
+      else if (format == "xpm3")
+        options.format = OutputFormat::xpm3;
+
+      else if (format == "xpmc")
+        options.format = OutputFormat::xpmc;
+
+      else if (format == "rgba")
+        options.format = OutputFormat::rgba;
+
+      else if (format == "ppm")
+        options.format = OutputFormat::ppm;
+
+      else if (format == "pam")
+        options.format = OutputFormat::pam;
+
+      else
+        usage_error("unknown output format");
+
+      has_format = true;
+    }
+
+    else if (arg == "-o")
+      options.output_dir = value();
+
+    else if (arg == "-l" || arg == "--list") {
+      const std::string_view list_path = value();
+
+      if (list_path == "-")
+        read_file_list(std::cin, options.file_paths);
+
+      else {
+        std::ifstream list((std::string)list_path);
+
+        if (!list)
+          usage_error("could not read the file list");
+
+        read_file_list(list, options.file_paths);
+      }
+    }
+
+    else if (arg == "-j")
+      options.thread_count = std::atoi(((std::string)value()).c_str());
+
+    else if (arg == "-m" || arg == "--max-memory") {
+      options.max_memory = (std::uintmax_t)std::strtoull(
+        ((std::string)value()).c_str(), nullptr, 10) << 20;
+    }
+
+    else if (arg == "-q")
+      options.quiet = true;
+
+    else if (arg == "--stats")
+      options.stats = true;
+
+    else if (arg == "--rle")
+      options.rle = true;
+
+    else if (arg == "--compact")
+      options.compact = true;
+
+    else if (arg == "-s" || arg == "--size") {
+      options.thumbnail_size = std::atoi(((std::string)value()).c_str());
+
+      if (options.thumbnail_size < 1)
+        usage_error("the thumbnail size must be at least 1");
+    }
+
+    else if (arg.size() > 1 && arg[0] == '-')
+      usage_error("unknown option");
+
+    else
+      add_path(arg, options.file_paths);
+  }
+
+  const bool xpm_format = options.format == OutputFormat::xpm2 ||
+    options.format == OutputFormat::xpm3 ||
+    options.format == OutputFormat::xpmc;
+
+  const bool writes_pixels = options.command == Command::render ||
+    options.command == Command::thumbnail;
+
+  if ((options.command == Command::convert || writes_pixels) && !has_format)
+  {
+    usage_error("--to is required");
+  }
+
+  if (options.command == Command::convert && !xpm_format)
+    usage_error("convert only writes xpm2, xpm3 or xpmc");
+
+  if (writes_pixels && xpm_format)
+    usage_error("render and thumbnail only write rgba, ppm or pam");
+
+  if (options.stats && (!XPM_STATS || options.command == Command::convert ||
+    options.command == Command::index))
+  {
+    usage_error("--stats needs XPM_STATS and a command that parses");
+  }
+
+  if (options.file_paths.empty())
+    usage_error("no files given");
+
+  return options;
+}
+
+// Caps the bytes of input held by in-flight jobs. A job that would exceed
+// the cap waits for others to finish, but a lone job always runs so files
+// larger than the cap are still processed.
+class MemoryBudget {
+  std::mutex _mutex;
+  std::condition_variable _released;
+  std::uintmax_t _limit;
+  std::uintmax_t _used;
+
+public:
+  explicit MemoryBudget(std::uintmax_t limit) : _limit(limit), _used(0) {}
+
+  void acquire(std::uintmax_t size) {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _released.wait(lock, [this, size]() {
+      return !_used || _used + size <= _limit;
+    });
+
+    _used += size;
+  }
+
+  void release(std::uintmax_t size) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+
+      _used -= size;
+    }
+
+    _released.notify_all();
+  }
+};
+
+// Files named *.xpm2 or *.xpm3 are taken at their word; anything else is
+// XPM3 if it opens like C source.
+static bool is_xpm3(const std::filesystem::path& file_path,
+  std::string_view file_contents)
+{
+  const std::string extension = file_path.extension().string();
+
+  if (extension == ".xpm2")
+    return false;
+
+  if (extension == ".xpm3")
+    return true;
+
+  const auto start_pos = file_contents.find_first_not_of(" \t\r\n");
+
+  return start_pos != std::string_view::npos &&
+    (file_contents.compare(start_pos, 2, "/*") == 0 ||
+    file_contents.compare(start_pos, 6, "static") == 0);
+}
+
+static std::string json_string(std::string_view s) {
+  std::string result = "\"";
+
+  for (auto ch : s) {
+    if (ch == '"' || ch == '\\') {
+      result += '\\';
+      result += ch;
+    }
+
+    else if ((unsigned char)ch < 0x20) {
+      char escape[8];
+
+      std::snprintf(escape, sizeof(escape), "\\u%04x", ch);
+      result += escape;
+    }
+
+    else
+      result += ch;
+  }
+
+  return result + '"';
+}
+
+static std::filesystem::path output_path(const Options& options,
+  const std::filesystem::path& file_path)
+{
+  static const char* const extensions[] = {
+    ".xpm2", ".xpm3", ".xpmc", ".rgba", ".ppm", ".pam"
+  };
+
+  std::filesystem::path result = options.output_dir.empty() ?
+    file_path : options.output_dir / file_path.filename();
+
+  // The extension is added to the whole file name so that x.xpm2 and x.xpm3
+  // do not collide, and thumbnails are named apart from full renders.
+  if (options.command == Command::index)
+    result = xpm_index_path(result);
+
+  else {
+    result += (options.command == Command::thumbnail ? ".thumb" : "") +
+      (std::string)extensions[(int)options.format];
+  }
+
+  return result;
+}
+
+// Finds the files whose output would overwrite an input, which may still be
+// mapped, or the output of an earlier file, which another thread may be
+// writing at the same time, such as same-named files from two directories
+// with -o. Returns why for each such file and an empty string for the rest.
+static std::vector<std::string> output_collisions(const Options& options) {
+  const auto& file_paths = options.file_paths;
+  std::vector<std::string> result(file_paths.size());
+
+  if (options.command == Command::validate)
+    return result;
+
+  std::map<std::filesystem::path, std::size_t> inputs;
+  std::map<std::filesystem::path, std::size_t> outputs;
+
+  for (std::size_t i = 0; i < file_paths.size(); i++)
+    inputs.emplace(file_paths[i].lexically_normal(), i);
+
+  for (std::size_t i = 0; i < file_paths.size(); i++) {
+    const auto path = output_path(options, file_paths[i]).lexically_normal();
+    const auto input = inputs.find(path);
+    const auto [output, inserted] = outputs.emplace(path, i);
+
+    if (input != inputs.end()) {
+      result[i] = "the output would overwrite the input " +
+        file_paths[input->second].string();
+    }
+
+    else if (!inserted) {
+      result[i] = "the output would overwrite that of " +
+        file_paths[output->second].string();
+    }
+  }
+
+  return result;
+}
+
+static void write_file(const std::filesystem::path& file_path,
+  const std::function<void(const XpmSink&)>& write_contents)
+{
+  FILE* file = std::fopen(file_path.string().c_str(), "wb");
+
+  auto write_error = [&file_path]() {
+    throw std::runtime_error("could not write to " + file_path.string() +
+      ": " + std::strerror(errno));
+  };
+
+  if (!file)
+    write_error();
+
+  try {
+    write_contents([file, &write_error](std::string_view chunk) {
+      if (std::fwrite(chunk.data(), 1, chunk.size(), file) != chunk.size())
+        write_error();
+    });
+  }
+
+  catch (...) {
+    std::fclose(file);
+
+    throw;
+  }
+
+  if (std::fclose(file))
+    write_error();
+}
+
+static void render(int width, int height,
+  const std::vector<std::uint32_t>& pixels, OutputFormat format,
+  const XpmSink& sink)
+{
+  const std::string width_value = std::to_string(width);
+  const std::string height_value = std::to_string(height);
+
+  if (format == OutputFormat::ppm) {
+    sink("P6\n" + width_value + ' ' + height_value + "\n255\n");
+
+    std::string row;
+
+    for (auto r = 0; r < height; r++) {
+      row.clear();
+
+      for (auto c = 0; c < width; c++) {
+        const auto* rgba = (const char*)&pixels[(std::size_t)r * width + c];
+
+        row.append(rgba, 3);
+      }
+
+      sink(row);
+    }
+
+    return;
+  }
+
+  if (format == OutputFormat::pam) {
+    sink("P7\nWIDTH " + width_value + "\nHEIGHT " + height_value +
+      "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n");
+  }
+
+  sink(std::string_view((const char*)pixels.data(),
+    pixels.size() * sizeof(std::uint32_t)));
+}
+
+// Unpacks every row, which also checks every index against the palette.
+static std::vector<std::uint32_t> rasterize(const CompiledXpm& compiled) {
+  std::vector<std::uint32_t> palette;
+  std::vector<std::uint32_t> result((std::size_t)compiled.width() *
+    compiled.height());
+
+  for (auto i = 0; i < compiled.colour_count(); i++)
+    palette.push_back(pack_pixel(compiled.colour(i), PixelFormat::rgba32));
+
+  for (auto r = 0; r < compiled.height(); r++) {
+    std::uint32_t* row = result.data() + (std::size_t)r * compiled.width();
+
+    compiled.ReadRow(r, row);
+
+    for (auto c = 0; c < compiled.width(); c++)
+      row[c] = palette[row[c]];
+  }
+
+  return result;
+}
+
+// Fits width by height within the thumbnail size, keeping the aspect ratio;
+// images that already fit are left at their size.
+static void write_thumbnail(const Options& options,
+  const std::filesystem::path& file_path, int width, int height,
+  const std::function<std::vector<std::uint32_t>(int, int)>& rasterize)
+{
+  const int size = options.thumbnail_size;
+  int thumbnail_width = width;
+  int thumbnail_height = height;
+
+  if (width > size || height > size) {
+    const int longest = std::max(width, height);
+
+    thumbnail_width = std::max(1, (int)((std::int64_t)width * size / longest));
+    thumbnail_height = std::max(1, (int)((std::int64_t)height * size /
+      longest));
+  }
+
+  const std::vector<std::uint32_t> pixels = rasterize(thumbnail_width,
+    thumbnail_height);
+
+  write_file(output_path(options, file_path),
+    [&options, thumbnail_width, thumbnail_height, &pixels](
+      const XpmSink& sink)
+    {
+      render(thumbnail_width, thumbnail_height, pixels, options.format, sink);
+    });
+}
+
+// Named as Xpm::Xpm2ToXpm3 names its arrays.
+static std::string array_name(const std::filesystem::path& file_path) {
+  std::string result = file_path.filename().string();
+
+  result = result.substr(0, result.find('.'));
+  std::replace(result.begin(), result.end(), ' ', '_');
+
+  return result;
+}
+
+// Compiled files are recognised by their contents whatever they are named.
+static void process_compiled_file(const Options& options,
+  const std::filesystem::path& file_path, std::string_view file_contents,
+  CompiledXpm& compiled)
+{
+  compiled.Load(file_contents);
+
+  if (options.command == Command::index)
+    throw std::runtime_error("compiled files need no index");
+
+  if (options.command == Command::convert) {
+    write_file(output_path(options, file_path),
+      [&options, &file_path, file_contents, &compiled](const XpmSink& sink) {
+        if (options.format == OutputFormat::xpmc)
+          sink(file_contents);
+
+        else {
+          write_xpm(compiled.writer_image(), options.format ==
+            OutputFormat::xpm3 ? XpmFormat::xpm3 : XpmFormat::xpm2,
+            array_name(file_path), sink);
+        }
+      });
+
+    return;
+  }
+
+  if (options.command == Command::thumbnail) {
+    std::vector<Rgba> palette;
+
+    for (auto i = 0; i < compiled.colour_count(); i++)
+      palette.push_back(compiled.colour(i));
+
+    write_thumbnail(options, file_path, compiled.width(), compiled.height(),
+      [&compiled, &palette](int width, int height) {
+        return rasterize_thumbnail(compiled.width(), compiled.height(),
+          palette.data(), [&compiled](int row, std::uint32_t* indices) {
+            compiled.ReadRow(row, indices);
+          }, width, height, PixelFormat::rgba32);
+      });
+
+    return;
+  }
+
+  const std::vector<std::uint32_t> pixels = rasterize(compiled);
+
+  if (options.command == Command::render) {
+    write_file(output_path(options, file_path),
+      [&options, &compiled, &pixels](const XpmSink& sink) {
+        render(compiled.width(), compiled.height(), pixels, options.format,
+          sink);
+      });
+  }
+}
+
+// Rows decoded together for a thumbnail, and the lazy decoder's tile size.
+static constexpr int thumbnail_band_rows = 64;
+
+// Reads decoder's rows a band of thumbnail_band_rows at a time, so that each
+// of its tiles is decoded once and only one band is held.
+static std::vector<std::uint32_t> rasterize_thumbnail(XpmLazyDecoder& decoder,
+  int width, int height)
+{
+  std::vector<std::uint32_t> band((std::size_t)decoder.width() *
+    thumbnail_band_rows);
+
+  return rasterize_thumbnail(decoder.width(), decoder.height(),
+    decoder.palette().data(), [&decoder, &band](int row, std::uint32_t* out) {
+      const int band_row = row % thumbnail_band_rows;
+
+      if (!band_row) {
+        decoder.ReadRegion(0, row, decoder.width(), std::min(
+          thumbnail_band_rows, decoder.height() - row), band.data(),
+          decoder.width());
+      }
+
+      const std::uint32_t* begin = band.data() + (std::size_t)band_row *
+        decoder.width();
+
+      std::copy(begin, begin + decoder.width(), out);
+    }, width, height, PixelFormat::rgba32);
+}
+
+static std::string dimensions(int width, int height) {
+  return std::to_string(width) + 'x' + std::to_string(height);
+}
+
+// Returns the image's dimensions where the command read them. Text files are
+// only parsed into xpm when the command needs the decoded image.
+static std::string process_file(const Options& options,
+  const std::filesystem::path& file_path, Xpm& xpm)
+{
+  const MappedFile file(file_path);
+
+  if (is_compiled_xpm(file.view())) {
+    CompiledXpm compiled;
+
+    process_compiled_file(options, file_path, file.view(), compiled);
+
+    return dimensions(compiled.width(), compiled.height());
+  }
+
+  const bool xpm3 = is_xpm3(file_path, file.view());
+
+  if (options.command == Command::validate && !options.stats) {
+    const XpmValidation validation = xpm3 ? validate_xpm3(file.view()) :
+      validate_xpm2(file.view());
+
+    if (!validation.valid())
+      throw std::runtime_error(validation.message());
+
+    std::string result = dimensions(validation.width, validation.height);
+
+    if (validation.warning.error != XpmError::none)
+      result += " warning: " + validation.warning.message();
+
+    return result;
+  }
+
+  if (options.command == Command::convert && !options.compact &&
+    options.format != OutputFormat::xpmc)
+  {
+    const bool to_xpm3 = options.format == OutputFormat::xpm3;
+
+    // Converting to the same format is a plain copy.
+    write_file(output_path(options, file_path),
+      [&file, &file_path, xpm3, to_xpm3](const XpmSink& sink) {
+        if (xpm3 == to_xpm3)
+          sink(file.view());
+
+        else if (to_xpm3)
+          Xpm::Xpm2ToXpm3(file_path.filename().wstring(), file.view(), sink);
+
+        else
+          Xpm::Xpm3ToXpm2(file.view(), sink);
+      });
+
+    return {};
+  }
+
+  if (options.command == Command::index) {
+    XpmLazyDecoder decoder;
+
+    if (xpm3)
+      decoder.ParseXpm3(file.view());
+
+    else
+      decoder.ParseXpm2(file.view());
+
+    decoder.IndexAllRows();
+
+    const std::filesystem::path index_path = output_path(options, file_path);
+    const std::string index = decoder.SaveIndex(xpm_index_time(file_path));
+
+    write_file(index_path, [&index](const XpmSink& sink) {
+      sink(index);
+    });
+
+    return {};
+  }
+
+  // Thumbnails only need each row once, so rows are decoded a band at a time
+  // rather than the whole image being held as indices. The file is validated
+  // first, which holds no pixels, for the parser's errors and checks.
+  if (options.command == Command::thumbnail && !options.stats) {
+    const XpmValidation validation = xpm3 ? validate_xpm3(file.view()) :
+      validate_xpm2(file.view());
+
+    if (!validation.valid())
+      throw std::runtime_error(validation.message());
+
+    XpmLazyDecoder decoder(thumbnail_band_rows, 1);
+
+    if (xpm3)
+      decoder.ParseXpm3(file.view());
+
+    else
+      decoder.ParseXpm2(file.view());
+
+    write_thumbnail(options, file_path, decoder.width(), decoder.height(),
+      [&decoder](int width, int height) {
+        return rasterize_thumbnail(decoder, width, height);
+      });
+
+    return dimensions(decoder.width(), decoder.height());
+  }
+
+  if (xpm3)
+    xpm.ParseXpm3(file.view());
+
+  else
+    xpm.ParseXpm2(file.view());
+
+  if (options.command == Command::convert) {
+    write_file(output_path(options, file_path),
+      [&options, &file_path, &xpm](const XpmSink& sink) {
+        if (options.format == OutputFormat::xpmc)
+          write_compiled_xpm(xpm, options.rle, sink);
+
+        else {
+          write_xpm(xpm, options.format == OutputFormat::xpm3 ?
+            XpmFormat::xpm3 : XpmFormat::xpm2, array_name(file_path), sink);
+        }
+      });
+  }
+
+  else if (options.command == Command::render) {
+    write_file(output_path(options, file_path),
+      [&options, &xpm](const XpmSink& sink) {
+        render(xpm.width(), xpm.height(), rasterize(xpm, PixelFormat::rgba32),
+          options.format, sink);
+      });
+  }
+
+  else if (options.command == Command::thumbnail) {
+    write_thumbnail(options, file_path, xpm.width(), xpm.height(),
+      [&xpm](int width, int height) {
+        return rasterize_thumbnail(xpm, width, height, PixelFormat::rgba32);
+      });
+  }
+
+  return dimensions(xpm.width(), xpm.height());
+}
+
+int main(int argc, char** argv) {
+  Options options;
+
+  try {
+    options = parse_options(argc, argv);
+  }
+
+  catch (const std::exception& ex) {
+    std::cerr << "xpm-cli: " << ex.what() << "\n\n";
+    print_usage();
+
+    return 2;
+  }
+
+  // -o may name a directory that does not exist yet. It is created before
+  // the files are processed, as they would all race to create it.
+  if (!options.output_dir.empty() && options.command != Command::validate) {
+    std::error_code ec;
+
+    std::filesystem::create_directories(options.output_dir, ec);
+
+    if (ec) {
+      std::cerr << "xpm-cli: could not create " <<
+        options.output_dir.string() << ": " << ec.message() << '\n';
+
+      return EXIT_FAILURE;
+    }
+  }
+
+  const std::vector<std::string> collisions = output_collisions(options);
+  MemoryBudget memory_budget(options.max_memory);
+  std::mutex output_mutex;
+  std::atomic<std::size_t> failure_count(0);
+
+  parallel_for(options.file_paths.size(), 1, options.thread_count,
+    [&](std::size_t begin, std::size_t end) {
+      for (auto i = begin; i < end; i++) {
+        const std::filesystem::path& file_path = options.file_paths[i];
+        std::error_code ec;
+
+        // Parsed images are several times their file size in memory, so
+        // budget for that rather than the bytes on disk alone.
+        const std::uintmax_t file_size = std::filesystem::file_size(
+          file_path, ec);
+
+        const std::uintmax_t cost = ec ? 0 : file_size * 4;
+        std::string result;
+
+        memory_budget.acquire(cost);
+
+        try {
+          if (!collisions[i].empty())
+            throw std::runtime_error(collisions[i]);
+
+          Xpm xpm;
+          const std::string size = process_file(options, file_path, xpm);
+
+          if (options.stats) {
+            result = "{\"file\":" + json_string(file_path.string()) +
+              ",\"stats\":" + xpm_stats_json(xpm.stats()) + '}';
+          }
+
+          else if (!options.quiet) {
+            result = file_path.string() + ": ok";
+
+            if (!size.empty())
+              result += ' ' + size;
+          }
+        }
+
+        catch (const std::exception& ex) {
+          failure_count++;
+          result = file_path.string() + ": error: " + ex.what();
+        }
+
+        memory_budget.release(cost);
+
+        if (!result.empty()) {
+          std::lock_guard<std::mutex> lock(output_mutex);
+
+          std::cout << result << '\n';
+        }
+      }
+    });
+
+  if (!options.quiet || failure_count) {
+    std::cout << options.file_paths.size() << " files, " << failure_count <<
+      " failed\n";
+  }
+
+  return failure_count ? EXIT_FAILURE : EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include "parallel.h"
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Resolves XPM pixel keys to palette indices in constant time. Keys of up to
+// two characters index a flat table directly, keys of up to eight characters
+// are packed into an integer and hashed with open addressing, and anything
+// wider is hashed and compared against a private copy of the key. The hashed
+// forms start out sized for the expected colour count and double as needed.
+class KeyTable {
+  int _chars_per_pixel;
+  std::pmr::vector<std::uint32_t> _direct;
+  std::pmr::vector<std::uint64_t> _packed_keys;
+  std::pmr::vector<std::uint32_t> _slots;
+  std::uint64_t _mask;
+  std::uint64_t _size;
+  std::pmr::string _wide_keys;
+
+  static std::uint64_t pack(std::string_view key) {
+    std::uint64_t result = 0;
+
+    for (std::string_view::size_type i = 0; i < key.size(); i++)
+      result |= (std::uint64_t)(unsigned char)key[i] << (i * 8);
+
+    return result;
+  }
+
+  static std::uint64_t hash_wide(std::string_view key) {
+    std::uint64_t result = 0xcbf29ce484222325;
+
+    for (const unsigned char ch : key)
+      result = (result ^ ch) * 0x100000001b3;
+
+    return result;
+  }
+
+  std::uint64_t slot_of(std::uint64_t hash) const {
+    return (hash * 0x9e3779b97f4a7c15) >> 32 & _mask;
+  }
+
+  std::string_view wide_key(std::uint32_t index) const {
+    return std::string_view(_wide_keys).substr(
+      (std::size_t)index * _chars_per_pixel, _chars_per_pixel);
+  }
+
+  void allocate_slots(std::uint64_t capacity) {
+    _mask = capacity - 1;
+    _slots.assign(capacity, npos);
+
+    if (_chars_per_pixel <= 8)
+      _packed_keys.assign(capacity, 0);
+  }
+
+  void grow() {
+    const std::pmr::vector<std::uint32_t> slots = std::move(_slots);
+    const std::pmr::vector<std::uint64_t> packed_keys = std::move(_packed_keys);
+
+    allocate_slots(slots.size() * 2);
+
+    for (std::size_t i = 0; i < slots.size(); i++) {
+      if (slots[i] == npos)
+        continue;
+
+      const std::uint64_t hash = packed_keys.empty() ?
+        hash_wide(wide_key(slots[i])) : packed_keys[i];
+
+      auto slot = slot_of(hash);
+
+      while (_slots[slot] != npos)
+        slot = (slot + 1) & _mask;
+
+      _slots[slot] = slots[i];
+
+      if (!packed_keys.empty())
+        _packed_keys[slot] = packed_keys[i];
+    }
+  }
+
+public:
+  static constexpr std::uint32_t npos = 0xffffffff;
+
+  // The table's storage comes from memory_resource. Clearing allow_direct
+  // hashes one- and two-character keys too, as a baseline for measuring the
+  // direct table.
+  KeyTable(int chars_per_pixel, int colour_count,
+    std::pmr::memory_resource* memory_resource =
+      std::pmr::get_default_resource(), bool allow_direct = true) :
+    _chars_per_pixel(chars_per_pixel), _direct(memory_resource),
+    _packed_keys(memory_resource), _slots(memory_resource), _mask(0),
+    _size(0), _wide_keys(memory_resource)
+  {
+    if (chars_per_pixel <= 2 && allow_direct) {
+      _direct.assign(chars_per_pixel == 1 ? 0x100 : 0x10000, npos);
+
+      return;
+    }
+
+    std::uint64_t capacity = 16;
+
+    while (capacity < (std::uint64_t)colour_count * 2)
+      capacity *= 2;
+
+    allocate_slots(capacity);
+  }
+
+  const int& chars_per_pixel() const {
+    return _chars_per_pixel;
+  }
+
+  // Only populated when chars_per_pixel is 1 or 2 and the direct table is
+  // allowed; indexed by the key's characters packed little-end first.
+  const std::uint32_t* direct() const {
+    return _direct.data();
+  }
+
+  // Returns false, leaving the table unchanged, if key is already present.
+  bool insert(std::string_view key, std::uint32_t index) {
+    if (!_direct.empty()) {
+      std::uint32_t& entry = _direct[(std::size_t)pack(key)];
+
+      if (entry != npos)
+        return false;
+
+      entry = index;
+
+      return true;
+    }
+
+    if ((_size + 1) * 2 > _slots.size())
+      grow();
+
+    if (!_packed_keys.empty()) {
+      const std::uint64_t packed = pack(key);
+
+      for (auto slot = slot_of(packed); ; slot = (slot + 1) & _mask) {
+        if (_slots[slot] == npos) {
+          _slots[slot] = index;
+          _packed_keys[slot] = packed;
+          _size++;
+
+          return true;
+        }
+
+        if (_packed_keys[slot] == packed)
+          return false;
+      }
+    }
+
+    for (auto slot = slot_of(hash_wide(key)); ; slot = (slot + 1) & _mask) {
+      if (_slots[slot] == npos) {
+        _slots[slot] = index;
+        _size++;
+
+        if (_wide_keys.size() < ((std::size_t)index + 1) * _chars_per_pixel)
+          _wide_keys.resize(((std::size_t)index + 1) * _chars_per_pixel);
+
+        _wide_keys.replace((std::size_t)index * _chars_per_pixel,
+          _chars_per_pixel, key);
+
+        return true;
+      }
+
+      if (wide_key(_slots[slot]) == key)
+        return false;
+    }
+  }
+
+  // Inserts every key of keys, chars_per_pixel apart, as the index of its
+  // position, into an empty table. The result is that of inserting them one
+  // at a time in order, so the first of any duplicates wins, but the hashed
+  // forms are built by up to thread_count threads: the slots are split into
+  // regions, each filled by one thread in key order, and the few keys whose
+  // probes run off the end of their region are inserted afterwards.
+  void insert_all(std::string_view keys, int thread_count) {
+    const std::size_t count = keys.size() / _chars_per_pixel;
+
+    auto key = [&keys, this](std::size_t index) {
+      return keys.substr(index * _chars_per_pixel, _chars_per_pixel);
+    };
+
+    while (count * 2 > _slots.size() && _direct.empty())
+      allocate_slots(_slots.size() * 2);
+
+    std::uint64_t region_count = 1;
+
+    while (region_count < (std::uint64_t)thread_count * 4 &&
+      region_count * 0x800 <= _slots.size())
+    {
+      region_count *= 2;
+    }
+
+    if (!_direct.empty() || thread_count == 1 || region_count == 1) {
+      for (std::size_t i = 0; i < count; i++)
+        insert(key(i), (std::uint32_t)i);
+
+      return;
+    }
+
+    std::pmr::memory_resource* const memory_resource =
+      _slots.get_allocator().resource();
+
+    std::pmr::vector<std::uint64_t> hashes(count, memory_resource);
+
+    if (_packed_keys.empty())
+      _wide_keys.assign(keys);
+
+    int region_shift = 0;
+
+    while ((region_count << region_shift) < _slots.size())
+      region_shift++;
+
+    auto region_of = [&hashes, region_shift, this](std::size_t index) {
+      return slot_of(hashes[index]) >> region_shift;
+    };
+
+    // Keys are bucketed by the region of their home slot with a counting
+    // sort over fixed chunks of keys, one per thread: each chunk hashes and
+    // counts its keys, the buckets are laid out region by region and chunk
+    // by chunk so that each stays in key order, and each chunk then places
+    // its keys. A region's thread touches only the keys in its bucket.
+    const auto chunk_count = (std::size_t)thread_count;
+    const std::size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+
+    std::pmr::vector<std::size_t> offsets(chunk_count * region_count, 0,
+      memory_resource);
+
+    parallel_for(chunk_count, 1, thread_count, [&](std::size_t begin,
+      std::size_t end)
+    {
+      for (auto chunk = begin; chunk < end; chunk++) {
+        std::size_t* const chunk_offsets = &offsets[chunk * region_count];
+        const auto chunk_end = std::min(count, (chunk + 1) * chunk_size);
+
+        for (auto i = chunk * chunk_size; i < chunk_end; i++) {
+          hashes[i] = _packed_keys.empty() ? hash_wide(key(i)) : pack(key(i));
+          chunk_offsets[region_of(i)]++;
+        }
+      }
+    });
+
+    std::pmr::vector<std::size_t> region_starts(region_count + 1,
+      memory_resource);
+
+    std::size_t bucketed = 0;
+
+    for (std::size_t region = 0; region < region_count; region++) {
+      region_starts[region] = bucketed;
+
+      for (std::size_t chunk = 0; chunk < chunk_count; chunk++) {
+        const std::size_t chunk_region_count =
+          offsets[chunk * region_count + region];
+
+        offsets[chunk * region_count + region] = bucketed;
+        bucketed += chunk_region_count;
+      }
+    }
+
+    region_starts[region_count] = bucketed;
+
+    std::pmr::vector<std::uint32_t> order(count, memory_resource);
+
+    parallel_for(chunk_count, 1, thread_count, [&](std::size_t begin,
+      std::size_t end)
+    {
+      for (auto chunk = begin; chunk < end; chunk++) {
+        std::size_t* const chunk_offsets = &offsets[chunk * region_count];
+        const auto chunk_end = std::min(count, (chunk + 1) * chunk_size);
+
+        for (auto i = chunk * chunk_size; i < chunk_end; i++)
+          order[chunk_offsets[region_of(i)]++] = (std::uint32_t)i;
+      }
+    });
+
+    std::pmr::vector<std::pmr::vector<std::uint32_t>> spills(region_count,
+      memory_resource);
+
+    std::atomic<std::uint64_t> size(0);
+
+    parallel_for(region_count, 1, thread_count, [&](std::size_t begin,
+      std::size_t end)
+    {
+      for (auto region = begin; region < end; region++) {
+        std::uint64_t region_size = 0;
+
+        for (auto j = region_starts[region]; j < region_starts[region + 1];
+          j++)
+        {
+          const std::uint32_t i = order[j];
+
+          for (auto slot = slot_of(hashes[i]); ; slot = (slot + 1) & _mask) {
+            if (slot >> region_shift != region) {
+              spills[region].push_back(i);
+
+              break;
+            }
+
+            if (_slots[slot] == npos) {
+              _slots[slot] = i;
+
+              if (!_packed_keys.empty())
+                _packed_keys[slot] = hashes[i];
+
+              region_size++;
+
+              break;
+            }
+
+            if (_packed_keys.empty() ? wide_key(_slots[slot]) == key(i) :
+              _packed_keys[slot] == hashes[i])
+            {
+              break;
+            }
+          }
+        }
+
+        size += region_size;
+      }
+    });
+
+    _size = size;
+
+    // Duplicates of a spilled key spill too, so inserting the spills in key
+    // order keeps the first of each.
+    std::pmr::vector<std::uint32_t> spilled(memory_resource);
+
+    for (const auto& region_spills : spills)
+      spilled.insert(spilled.end(), region_spills.begin(),
+        region_spills.end());
+
+    std::sort(spilled.begin(), spilled.end());
+
+    for (const auto index : spilled)
+      insert(key(index), index);
+  }
+
+  std::uint32_t find(std::string_view key) const {
+    if (!_direct.empty())
+      return _direct[(std::size_t)pack(key)];
+
+    if (!_packed_keys.empty()) {
+      const std::uint64_t packed = pack(key);
+
+      for (auto slot = slot_of(packed); ; slot = (slot + 1) & _mask) {
+        if (_slots[slot] == npos || _packed_keys[slot] == packed)
+          return _slots[slot];
+      }
+    }
+
+    for (auto slot = slot_of(hash_wide(key)); ; slot = (slot + 1) & _mask) {
+      if (_slots[slot] == npos || wide_key(_slots[slot]) == key)
+        return _slots[slot];
+    }
+  }
+};
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "mapped_file.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static void read_file_error() {
+  throw std::runtime_error("Could not read file");
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile() : _data(nullptr), _size(0),
+  _file(INVALID_HANDLE_VALUE), _mapping(nullptr)
+{
+
+}
+
+MappedFile::MappedFile(const std::filesystem::path& file_path) : MappedFile()
+{
+  _file = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+    nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+  if (_file == INVALID_HANDLE_VALUE)
+    read_file_error();
+
+  LARGE_INTEGER file_size = {};
+
+  if (!GetFileSizeEx(_file, &file_size)) {
+    Close();
+    read_file_error();
+  }
+
+  _size = (std::size_t)file_size.QuadPart;
+
+  // Empty files cannot be mapped, and an empty view needs no mapping.
+  if (!_size)
+    return;
+
+  _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+  if (!_mapping) {
+    Close();
+    read_file_error();
+  }
+
+  _data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0,
+    0, 0));
+
+  if (!_data) {
+    Close();
+    read_file_error();
+  }
+}
+
+void MappedFile::Close() {
+  if (_data)
+    UnmapViewOfFile(_data);
+
+  if (_mapping)
+    CloseHandle(_mapping);
+
+  if (_file != INVALID_HANDLE_VALUE)
+    CloseHandle(_file);
+
+  _data = nullptr;
+  _size = 0;
+  _file = INVALID_HANDLE_VALUE;
+  _mapping = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : _data(other._data),
+  _size(other._size), _file(other._file), _mapping(other._mapping)
+{
+  other._data = nullptr;
+  other._size = 0;
+  other._file = INVALID_HANDLE_VALUE;
+  other._mapping = nullptr;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Close();
+
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    std::swap(_file, other._file);
+    std::swap(_mapping, other._mapping);
+  }
+
+  return *this;
+}
+#else
+MappedFile::MappedFile() : _data(nullptr), _size(0)
+{
+
+}
+
+MappedFile::MappedFile(const std::filesystem::path& file_path) : MappedFile()
+{
+  const int file = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (file == -1)
+    read_file_error();
+
+  struct stat file_stat = {};
+
+  if (fstat(file, &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
+    close(file);
+    read_file_error();
+  }
+
+  _size = (std::size_t)file_stat.st_size;
+
+  if (_size) {
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    if (data == MAP_FAILED) {
+      close(file);
+      read_file_error();
+    }
+
+    madvise(data, _size, MADV_SEQUENTIAL);
+
+    _data = static_cast<const char*>(data);
+  }
+
+  // The mapping keeps its own reference to the file.
+  close(file);
+}
+
+void MappedFile::Close() {
+  if (_data)
+    munmap(const_cast<char*>(_data), _size);
+
+  _data = nullptr;
+  _size = 0;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : _data(other._data),
+  _size(other._size)
+{
+  other._data = nullptr;
+  other._size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Close();
+
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+  }
+
+  return *this;
+}
+#endif
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+std::string_view MappedFile::view() const {
+  return std::string_view(_data, _size);
+}
\ No newline at end of file
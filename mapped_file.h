@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// A read-only view of a whole file, backed by mmap on POSIX and a file
+// mapping on Windows so the contents are never copied into the process.
+class MappedFile {
+  const char* _data;
+  std::size_t _size;
+#ifdef _WIN32
+  void* _file;
+  void* _mapping;
+#endif
+
+  void Close();
+
+public:
+  MappedFile();
+  explicit MappedFile(const std::filesystem::path& file_path);
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+  std::string_view view() const;
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+#include "xpm_stats.h"
+
+// Resolves a requested thread count, where 0 means one per hardware thread.
+inline int resolve_thread_count(int thread_count) {
+  if (thread_count > 0)
+    return thread_count;
+
+  return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+// Runs task(begin, end) over [0, count) in blocks of block_size, handed out
+// from a shared counter to thread_count threads (the caller among them) so
+// uneven blocks balance themselves. The first exception thrown by a task is
+// rethrown once every thread has stopped.
+template <typename Task>
+void parallel_for(std::size_t count, std::size_t block_size, int thread_count,
+  Task task)
+{
+  const std::size_t block_count = (count + block_size - 1) / block_size;
+
+  thread_count = (int)std::min<std::size_t>(resolve_thread_count(thread_count),
+    block_count);
+
+  if (thread_count <= 1) {
+    if (count)
+      task((std::size_t)0, count);
+
+    return;
+  }
+
+  std::atomic<std::size_t> next_block(0);
+  std::vector<std::exception_ptr> errors(thread_count);
+
+#if XPM_STATS
+  // The workers' allocations are credited to the caller on return.
+  XpmAllocationScope allocation_scope;
+#endif
+
+  auto work = [&](int thread_index) {
+#if XPM_STATS
+    if (thread_index)
+      allocation_scope.join();
+#endif
+
+    try {
+      for (auto block = next_block++; block < block_count;
+        block = next_block++)
+      {
+        const std::size_t begin = block * block_size;
+
+        task(begin, std::min(begin + block_size, count));
+      }
+    }
+
+    catch (...) {
+      errors[thread_index] = std::current_exception();
+      next_block = block_count;
+    }
+  };
+
+  std::vector<std::thread> threads;
+
+  threads.reserve(thread_count - 1);
+
+  try {
+    for (auto i = 1; i < thread_count; i++)
+      threads.emplace_back(work, i);
+  }
+
+  catch (...) {
+    next_block = block_count;
+
+    for (auto& thread : threads)
+      thread.join();
+
+    throw;
+  }
+
+  work(0);
+
+  for (auto& thread : threads)
+    thread.join();
+
+  for (const auto& error : errors)
+    if (error)
+      std::rethrow_exception(error);
+}
+
+// Lowers target to value if value is smaller; used to keep the earliest
+// failure when several threads can fail at once.
+template <typename T>
+void atomic_min(std::atomic<T>& target, T value) {
+  T current = target.load();
+
+  while (value < current && !target.compare_exchange_weak(current, value)) {
+
+  }
+}
\ No newline at end of file
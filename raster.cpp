@@ -0,0 +1,191 @@
+#include "raster.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <variant>
+
+std::uint32_t pack_pixel(const Rgba& rgba, PixelFormat format) {
+  std::uint8_t bytes[4] = {};
+
+  switch (format) {
+  case PixelFormat::rgba32:
+    bytes[0] = (std::uint8_t)rgba.r;
+    bytes[1] = (std::uint8_t)rgba.g;
+    bytes[2] = (std::uint8_t)rgba.b;
+    bytes[3] = (std::uint8_t)rgba.a;
+
+    break;
+
+  case PixelFormat::bgra32_premultiplied:
+    bytes[0] = (std::uint8_t)((rgba.b * rgba.a + 127) / 255);
+    bytes[1] = (std::uint8_t)((rgba.g * rgba.a + 127) / 255);
+    bytes[2] = (std::uint8_t)((rgba.r * rgba.a + 127) / 255);
+    bytes[3] = (std::uint8_t)rgba.a;
+
+    break;
+  }
+
+  std::uint32_t result;
+
+  std::memcpy(&result, bytes, sizeof(result));
+
+  return result;
+}
+
+std::vector<std::uint32_t> rasterize_palette(const Xpm& xpm,
+  PixelFormat format)
+{
+  std::vector<std::uint32_t> result;
+
+  result.reserve(xpm.palette().size());
+
+  for (const auto& rgba : xpm.palette())
+    result.push_back(pack_pixel(rgba, format));
+
+  return result;
+}
+
+void rasterize(const Xpm& xpm, const std::uint32_t* palette,
+  std::uint32_t* out, std::ptrdiff_t stride)
+{
+  const auto width = xpm.width();
+
+  std::visit([&](const auto& indices) {
+    for (auto r = 0; r < xpm.height(); r++) {
+      const auto* row = indices.data() + (std::size_t)r * width;
+      std::uint32_t* out_row = out + r * stride;
+
+      for (auto c = 0; c < width; c++)
+        out_row[c] = palette[row[c]];
+    }
+  }, xpm.indices());
+}
+
+std::vector<std::uint32_t> rasterize(const Xpm& xpm, PixelFormat format) {
+  std::vector<std::uint32_t> result((std::size_t)xpm.width() * xpm.height());
+
+  rasterize(xpm, rasterize_palette(xpm, format).data(), result.data(),
+    xpm.width());
+
+  return result;
+}
+
+// Where each source pixel lands along one axis: its first output pixel and
+// the weight it gives that one, the rest of output_size going to the next.
+// Output pixel i covers [i * source_size, (i + 1) * source_size) of a span in
+// which each source pixel is output_size wide, so that weights are exact.
+struct ThumbnailSpan {
+  int first;
+  std::uint64_t first_weight;
+};
+
+static std::vector<ThumbnailSpan> thumbnail_spans(int source_size,
+  int output_size)
+{
+  std::vector<ThumbnailSpan> result(source_size);
+
+  for (auto i = 0; i < source_size; i++) {
+    const std::uint64_t start = (std::uint64_t)i * output_size;
+    const std::uint64_t first = start / source_size;
+    const std::uint64_t boundary = (first + 1) * source_size;
+
+    result[i] = { (int)first, std::min<std::uint64_t>(boundary - start,
+      output_size) };
+  }
+
+  return result;
+}
+
+std::vector<std::uint32_t> rasterize_thumbnail(int source_width,
+  int source_height, const Rgba* palette, const XpmRowReader& read_row,
+  int width, int height, PixelFormat format)
+{
+  if (width < 1 || height < 1 || width > source_width ||
+    height > source_height)
+  {
+    throw std::invalid_argument("thumbnails can only shrink an image");
+  }
+
+  const std::vector<ThumbnailSpan> columns = thumbnail_spans(source_width,
+    width);
+
+  const std::vector<ThumbnailSpan> rows = thumbnail_spans(source_height,
+    height);
+
+  // Sums of alpha-weighted R, G and B and of alpha for every output pixel,
+  // and for the output row of the source row being read.
+  std::vector<double> sums((std::size_t)width * height * 4);
+  std::vector<double> row_sums((std::size_t)width * 4);
+  std::vector<std::uint32_t> indices(source_width);
+
+  for (auto r = 0; r < source_height; r++) {
+    read_row(r, indices.data());
+    std::fill(row_sums.begin(), row_sums.end(), 0.0);
+
+    for (auto c = 0; c < source_width; c++) {
+      const Rgba& rgba = palette[indices[c]];
+
+      if (!rgba.a)
+        continue;
+
+      const double a = rgba.a;
+      const double pixel[4] = { rgba.r * a, rgba.g * a, rgba.b * a, a };
+      const ThumbnailSpan& span = columns[c];
+      double* sum = &row_sums[(std::size_t)span.first * 4];
+
+      for (auto i = 0; i < 4; i++)
+        sum[i] += pixel[i] * span.first_weight;
+
+      if (span.first_weight < (std::uint64_t)width) {
+        for (auto i = 0; i < 4; i++)
+          sum[i + 4] += pixel[i] * (width - span.first_weight);
+      }
+    }
+
+    const ThumbnailSpan& span = rows[r];
+    double* sum = &sums[(std::size_t)span.first * width * 4];
+
+    for (std::size_t i = 0; i < row_sums.size(); i++)
+      sum[i] += row_sums[i] * span.first_weight;
+
+    if (span.first_weight < (std::uint64_t)height) {
+      sum += (std::size_t)width * 4;
+
+      for (std::size_t i = 0; i < row_sums.size(); i++)
+        sum[i] += row_sums[i] * (height - span.first_weight);
+    }
+  }
+
+  // Every output pixel gathers weights totalling source_width by
+  // source_height, which scales its alpha back to 0 to 255; its colour is
+  // divided by its alpha instead.
+  const double area = (double)source_width * source_height;
+  std::vector<std::uint32_t> result((std::size_t)width * height);
+
+  for (std::size_t i = 0; i < result.size(); i++) {
+    const double* sum = &sums[i * 4];
+    Rgba rgba = {};
+
+    if (sum[3] > 0) {
+      rgba = { (int)(sum[0] / sum[3] + 0.5), (int)(sum[1] / sum[3] + 0.5),
+        (int)(sum[2] / sum[3] + 0.5), (int)(sum[3] / area + 0.5) };
+    }
+
+    result[i] = pack_pixel(rgba, format);
+  }
+
+  return result;
+}
+
+std::vector<std::uint32_t> rasterize_thumbnail(const Xpm& xpm, int width,
+  int height, PixelFormat format)
+{
+  return std::visit([&](const auto& indices) {
+    return rasterize_thumbnail(xpm.width(), xpm.height(),
+      xpm.palette().data(), [&xpm, &indices](int row, std::uint32_t* out) {
+        const auto* begin = indices.data() + (std::size_t)row * xpm.width();
+
+        std::copy(begin, begin + xpm.width(), out);
+      }, width, height, format);
+  }, xpm.indices());
+}
\ No newline at end of file
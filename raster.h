@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "rgb.h"
+#include <vector>
+#include "xpm.h"
+
+enum class PixelFormat
+{
+  // R, G, B, A in ascending byte order.
+  rgba32,
+  // B, G, R, A in ascending byte order with colour scaled by alpha, as
+  // expected by 32-bit GDI DIB sections.
+  bgra32_premultiplied,
+};
+
+std::uint32_t pack_pixel(const Rgba& rgba, PixelFormat format);
+
+// Expands every palette entry of xpm into a packed 32-bit pixel.
+std::vector<std::uint32_t> rasterize_palette(const Xpm& xpm,
+  PixelFormat format);
+
+// Writes xpm's pixels into out, looking each palette index up in palette;
+// stride is the distance between rows of out in pixels.
+void rasterize(const Xpm& xpm, const std::uint32_t* palette,
+  std::uint32_t* out, std::ptrdiff_t stride);
+
+std::vector<std::uint32_t> rasterize(const Xpm& xpm, PixelFormat format);
+
+// Writes the palette index of each pixel in row to indices.
+using XpmRowReader = std::function<void(int row, std::uint32_t* indices)>;
+
+// Shrinks a source_width by source_height image to width by height with an
+// area filter, reading the source a row at a time so that only the output is
+// ever held in full. Colours are weighted by alpha, so transparent pixels
+// fade the result's alpha without darkening its colour. width and height are
+// at least 1 and at most the source's.
+std::vector<std::uint32_t> rasterize_thumbnail(int source_width,
+  int source_height, const Rgba* palette, const XpmRowReader& read_row,
+  int width, int height, PixelFormat format);
+
+std::vector<std::uint32_t> rasterize_thumbnail(const Xpm& xpm, int width,
+  int height, PixelFormat format);
\ No newline at end of file
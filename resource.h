@@ -1,22 +1,22 @@
-//{{NO_DEPENDENCIES}}
-// Microsoft Visual C++ generated include file.
-// Used by xpm-viewer.rc
-//
-#define IDR_MENU                        101
-#define ID_FILE_OPEN                    40001
-#define ID_ZOOM_IN                      40002
-#define ID_ZOOM_OUT                     40003
-#define ID_FILE_EXPORTAS                40004
-#define ID_EXPORTAS_XPM2                40005
-#define ID_EXPORTAS_XPM3                40006
-
-// Next default values for new objects
-// 
-#ifdef APSTUDIO_INVOKED
-#ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        102
-#define _APS_NEXT_COMMAND_VALUE         40007
-#define _APS_NEXT_CONTROL_VALUE         1001
-#define _APS_NEXT_SYMED_VALUE           101
-#endif
-#endif
+//{{NO_DEPENDENCIES}}
+// Microsoft Visual C++ generated include file.
+// Used by xpm-viewer.rc
+//
+#define IDR_MENU                        101
+#define ID_FILE_OPEN                    40001
+#define ID_ZOOM_IN                      40002
+#define ID_ZOOM_OUT                     40003
+#define ID_FILE_EXPORTAS                40004
+#define ID_EXPORTAS_XPM2                40005
+#define ID_EXPORTAS_XPM3                40006
+
+// Next default values for new objects
+// 
+#ifdef APSTUDIO_INVOKED
+#ifndef APSTUDIO_READONLY_SYMBOLS
+#define _APS_NEXT_RESOURCE_VALUE        102
+#define _APS_NEXT_COMMAND_VALUE         40007
+#define _APS_NEXT_CONTROL_VALUE         1001
+#define _APS_NEXT_SYMED_VALUE           101
+#endif
+#endif
\ No newline at end of file
@@ -1,14 +1,14 @@
-#pragma once
-
-struct Rgb {
-  int r;
-  int g;
-  int b;
-};
-
-struct Rgba {
-  int r;
-  int g;
-  int b;
-  int a;
+#pragma once
+
+struct Rgb {
+  int r;
+  int g;
+  int b;
+};
+
+struct Rgba {
+  int r;
+  int g;
+  int b;
+  int a;
 };
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "simd_decode.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+  defined(_M_IX86)
+#define XPM_X86
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define XPM_TARGET_AVX2
+#else
+#define XPM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+template <typename Index>
+static bool translate_keys_scalar(const unsigned char* keys,
+  const std::uint32_t* table, Index* out, int count)
+{
+  std::uint32_t undefined = 0;
+
+  for (auto i = 0; i < count; i++) {
+    const std::uint32_t index = table[keys[i]];
+
+    undefined |= index;
+    out[i] = (Index)index;
+  }
+
+  return !(undefined >> 31);
+}
+
+#ifdef XPM_X86
+static bool cpu_has_avx2() {
+#ifdef _MSC_VER
+  int info[4];
+
+  __cpuid(info, 0);
+
+  if (info[0] < 7)
+    return false;
+
+  __cpuid(info, 1);
+
+  // OSXSAVE and AVX, then check the OS saves the YMM state.
+  if ((info[2] & (1 << 27 | 1 << 28)) != (1 << 27 | 1 << 28))
+    return false;
+
+  if ((_xgetbv(0) & 6) != 6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+
+  return info[1] & 1 << 5;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// Eight keys widen to eight 32-bit lanes per gather; the bytes of every
+// gathered entry are OR-ed together so one test per row finds undefined keys.
+XPM_TARGET_AVX2
+static __m256i gather_keys(const unsigned char* keys, const int* table) {
+  const __m128i raw = _mm_loadl_epi64((const __m128i*)keys);
+
+  return _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(raw), 4);
+}
+
+XPM_TARGET_AVX2
+static bool translate_keys_avx2(const unsigned char* keys,
+  const std::uint32_t* table, std::uint8_t* out, int count)
+{
+  const auto* entries = (const int*)table;
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  __m256i undefined = _mm256_setzero_si256();
+  auto i = 0;
+
+  for (; i + 32 <= count; i += 32) {
+    const __m256i a = gather_keys(keys + i, entries);
+    const __m256i b = gather_keys(keys + i + 8, entries);
+    const __m256i c = gather_keys(keys + i + 16, entries);
+    const __m256i d = gather_keys(keys + i + 24, entries);
+
+    undefined = _mm256_or_si256(undefined, _mm256_or_si256(
+      _mm256_or_si256(a, b), _mm256_or_si256(c, d)));
+
+    const __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(a, b),
+      _mm256_packus_epi32(c, d));
+
+    _mm256_storeu_si256((__m256i*)(out + i),
+      _mm256_permutevar8x32_epi32(packed, order));
+  }
+
+  if (_mm256_movemask_ps(_mm256_castsi256_ps(undefined)))
+    return false;
+
+  return translate_keys_scalar(keys + i, table, out + i, count - i);
+}
+
+XPM_TARGET_AVX2
+static bool translate_keys_avx2(const unsigned char* keys,
+  const std::uint32_t* table, std::uint16_t* out, int count)
+{
+  const auto* entries = (const int*)table;
+  __m256i undefined = _mm256_setzero_si256();
+  auto i = 0;
+
+  for (; i + 16 <= count; i += 16) {
+    const __m256i a = gather_keys(keys + i, entries);
+    const __m256i b = gather_keys(keys + i + 8, entries);
+
+    undefined = _mm256_or_si256(undefined, _mm256_or_si256(a, b));
+
+    _mm256_storeu_si256((__m256i*)(out + i), _mm256_permute4x64_epi64(
+      _mm256_packus_epi32(a, b), 0xd8));
+  }
+
+  if (_mm256_movemask_ps(_mm256_castsi256_ps(undefined)))
+    return false;
+
+  return translate_keys_scalar(keys + i, table, out + i, count - i);
+}
+
+XPM_TARGET_AVX2
+static bool translate_keys_avx2(const unsigned char* keys,
+  const std::uint32_t* table, std::uint32_t* out, int count)
+{
+  const auto* entries = (const int*)table;
+  __m256i undefined = _mm256_setzero_si256();
+  auto i = 0;
+
+  for (; i + 8 <= count; i += 8) {
+    const __m256i a = gather_keys(keys + i, entries);
+
+    undefined = _mm256_or_si256(undefined, a);
+    _mm256_storeu_si256((__m256i*)(out + i), a);
+  }
+
+  if (_mm256_movemask_ps(_mm256_castsi256_ps(undefined)))
+    return false;
+
+  return translate_keys_scalar(keys + i, table, out + i, count - i);
+}
+#endif
+
+// SSE2 has no gather, so machines without AVX2 take the scalar loop.
+template <typename Index>
+static bool dispatch_translate_keys(const unsigned char* keys,
+  const std::uint32_t* table, Index* out, int count)
+{
+#ifdef XPM_X86
+  static const bool has_avx2 = cpu_has_avx2();
+
+  if (has_avx2)
+    return translate_keys_avx2(keys, table, out, count);
+#endif
+
+  return translate_keys_scalar(keys, table, out, count);
+}
+
+bool translate_keys(const unsigned char* keys, const std::uint32_t* table,
+  std::uint8_t* out, int count)
+{
+  return dispatch_translate_keys(keys, table, out, count);
+}
+
+bool translate_keys(const unsigned char* keys, const std::uint32_t* table,
+  std::uint16_t* out, int count)
+{
+  return dispatch_translate_keys(keys, table, out, count);
+}
+
+bool translate_keys(const unsigned char* keys, const std::uint32_t* table,
+  std::uint32_t* out, int count)
+{
+  return dispatch_translate_keys(keys, table, out, count);
+}
\ No newline at end of file
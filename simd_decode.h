@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// Translates count one-character keys to palette indices through a KeyTable's
+// 256-entry direct table, returning false if any key maps to KeyTable::npos,
+// which any entry with its top bit set is taken to be. Uses AVX2 gathers when
+// the CPU supports them and a scalar loop otherwise; there is no SSE2 path,
+// as SSE2 has no gather.
+bool translate_keys(const unsigned char* keys, const std::uint32_t* table,
+  std::uint8_t* out, int count);
+
+bool translate_keys(const unsigned char* keys, const std::uint32_t* table,
+  std::uint16_t* out, int count);
+
+bool translate_keys(const unsigned char* keys, const std::uint32_t* table,
+  std::uint32_t* out, int count);
\ No newline at end of file
@@ -1,703 +1,900 @@
-#pragma once
-
-#include <unordered_map>
-#include <string_view>
-#include "rgb.h"
-
-const std::unordered_map<std::string_view, Rgb> x11_colour_map = {
-  {"snow", {255, 250, 250}},
-  {"ghost", {248, 248, 255}},
-  {"ghostwhite", {248, 248, 255}},
-  {"white", {255, 255, 255}},
-  {"whitesmoke", {245, 245, 245}},
-  {"gainsboro", {220, 220, 220}},
-  {"floral", {255, 250, 240}},
-  {"floralwhite", {255, 250, 240}},
-  {"old", {253, 245, 230}},
-  {"oldlace", {253, 245, 230}},
-  {"linen", {250, 240, 230}},
-  {"antique", {250, 235, 215}},
-  {"antiquewhite", {250, 235, 215}},
-  {"papaya", {255, 239, 213}},
-  {"papayawhip", {255, 239, 213}},
-  {"blanched", {255, 235, 205}},
-  {"blanchedalmond", {255, 235, 205}},
-  {"bisque", {255, 228, 196}},
-  {"peach", {255, 218, 185}},
-  {"peachpuff", {255, 218, 185}},
-  {"navajo", {255, 222, 173}},
-  {"navajowhite", {255, 222, 173}},
-  {"moccasin", {255, 228, 181}},
-  {"cornsilk", {255, 248, 220}},
-  {"ivory", {255, 255, 240}},
-  {"lemon", {255, 250, 205}},
-  {"lemonchiffon", {255, 250, 205}},
-  {"seashell", {255, 245, 238}},
-  {"honeydew", {240, 255, 240}},
-  {"mint", {245, 255, 250}},
-  {"mintcream", {245, 255, 250}},
-  {"azure", {240, 255, 255}},
-  {"alice", {240, 248, 255}},
-  {"aliceblue", {240, 248, 255}},
-  {"lavender", {255, 240, 245}},
-  {"lavenderblush", {255, 240, 245}},
-  {"misty", {255, 228, 225}},
-  {"mistyrose", {255, 228, 225}},
-  {"black", {0, 0, 0}},
-  {"dark", {139, 0, 0}},
-  {"darkslategray", {47, 79, 79}},
-  {"darkslategrey", {47, 79, 79}},
-  {"dim", {105, 105, 105}},
-  {"dimgray", {105, 105, 105}},
-  {"dimgrey", {105, 105, 105}},
-  {"slate", {106, 90, 205}},
-  {"slategray", {112, 128, 144}},
-  {"slategrey", {112, 128, 144}},
-  {"light", {144, 238, 144}},
-  {"lightslategray", {119, 136, 153}},
-  {"lightslategrey", {119, 136, 153}},
-  {"gray", {190, 190, 190}},
-  {"grey", {190, 190, 190}},
-  {"lightgrey", {211, 211, 211}},
-  {"lightgray", {211, 211, 211}},
-  {"midnight", {25, 25, 112}},
-  {"midnightblue", {25, 25, 112}},
-  {"navy", {0, 0, 128}},
-  {"navyblue", {0, 0, 128}},
-  {"cornflower", {100, 149, 237}},
-  {"cornflowerblue", {100, 149, 237}},
-  {"darkslateblue", {72, 61, 139}},
-  {"slateblue", {106, 90, 205}},
-  {"medium", {147, 112, 219}},
-  {"mediumslateblue", {123, 104, 238}},
-  {"lightslateblue", {132, 112, 255}},
-  {"mediumblue", {0, 0, 205}},
-  {"royal", {65, 105, 225}},
-  {"royalblue", {65, 105, 225}},
-  {"blue", {138, 43, 226}},
-  {"dodger", {30, 144, 255}},
-  {"dodgerblue", {30, 144, 255}},
-  {"deep", {255, 20, 147}},
-  {"deepskyblue", {0, 191, 255}},
-  {"sky", {135, 206, 235}},
-  {"skyblue", {135, 206, 235}},
-  {"lightskyblue", {135, 206, 250}},
-  {"steel", {70, 130, 180}},
-  {"steelblue", {70, 130, 180}},
-  {"lightsteelblue", {176, 196, 222}},
-  {"lightblue", {173, 216, 230}},
-  {"powder", {176, 224, 230}},
-  {"powderblue", {176, 224, 230}},
-  {"pale", {219, 112, 147}},
-  {"paleturquoise", {175, 238, 238}},
-  {"darkturquoise", {0, 206, 209}},
-  {"mediumturquoise", {72, 209, 204}},
-  {"turquoise", {64, 224, 208}},
-  {"cyan", {0, 255, 255}},
-  {"lightcyan", {224, 255, 255}},
-  {"cadet", {95, 158, 160}},
-  {"cadetblue", {95, 158, 160}},
-  {"mediumaquamarine", {102, 205, 170}},
-  {"aquamarine", {127, 255, 212}},
-  {"darkgreen", {0, 100, 0}},
-  {"darkolivegreen", {85, 107, 47}},
-  {"darkseagreen", {143, 188, 143}},
-  {"sea", {46, 139, 87}},
-  {"seagreen", {46, 139, 87}},
-  {"mediumseagreen", {60, 179, 113}},
-  {"lightseagreen", {32, 178, 170}},
-  {"palegreen", {152, 251, 152}},
-  {"spring", {0, 255, 127}},
-  {"springgreen", {0, 255, 127}},
-  {"lawn", {124, 252, 0}},
-  {"lawngreen", {124, 252, 0}},
-  {"green", {173, 255, 47}},
-  {"chartreuse", {127, 255, 0}},
-  {"mediumspringgreen", {0, 250, 154}},
-  {"greenyellow", {173, 255, 47}},
-  {"lime", {50, 205, 50}},
-  {"limegreen", {50, 205, 50}},
-  {"yellow", {255, 255, 0}},
-  {"yellowgreen", {154, 205, 50}},
-  {"forest", {34, 139, 34}},
-  {"forestgreen", {34, 139, 34}},
-  {"olive", {107, 142, 35}},
-  {"olivedrab", {107, 142, 35}},
-  {"darkkhaki", {189, 183, 107}},
-  {"khaki", {240, 230, 140}},
-  {"palegoldenrod", {238, 232, 170}},
-  {"lightgoldenrodyellow", {250, 250, 210}},
-  {"lightyellow", {255, 255, 224}},
-  {"gold", {255, 215, 0}},
-  {"lightgoldenrod", {238, 221, 130}},
-  {"goldenrod", {218, 165, 32}},
-  {"darkgoldenrod", {184, 134, 11}},
-  {"rosy", {188, 143, 143}},
-  {"rosybrown", {188, 143, 143}},
-  {"indian", {205, 92, 92}},
-  {"indianred", {205, 92, 92}},
-  {"saddle", {139, 69, 19}},
-  {"saddlebrown", {139, 69, 19}},
-  {"sienna", {160, 82, 45}},
-  {"peru", {205, 133, 63}},
-  {"burlywood", {222, 184, 135}},
-  {"beige", {245, 245, 220}},
-  {"wheat", {245, 222, 179}},
-  {"sandy", {244, 164, 96}},
-  {"sandybrown", {244, 164, 96}},
-  {"tan", {210, 180, 140}},
-  {"chocolate", {210, 105, 30}},
-  {"firebrick", {178, 34, 34}},
-  {"brown", {165, 42, 42}},
-  {"darksalmon", {233, 150, 122}},
-  {"salmon", {250, 128, 114}},
-  {"lightsalmon", {255, 160, 122}},
-  {"orange", {255, 69, 0}},
-  {"darkorange", {255, 140, 0}},
-  {"coral", {255, 127, 80}},
-  {"lightcoral", {240, 128, 128}},
-  {"tomato", {255, 99, 71}},
-  {"orangered", {255, 69, 0}},
-  {"red", {255, 0, 0}},
-  {"hot", {255, 105, 180}},
-  {"hotpink", {255, 105, 180}},
-  {"deeppink", {255, 20, 147}},
-  {"pink", {255, 192, 203}},
-  {"lightpink", {255, 182, 193}},
-  {"palevioletred", {219, 112, 147}},
-  {"maroon", {176, 48, 96}},
-  {"mediumvioletred", {199, 21, 133}},
-  {"violet", {238, 130, 238}},
-  {"violetred", {208, 32, 144}},
-  {"magenta", {255, 0, 255}},
-  {"plum", {221, 160, 221}},
-  {"orchid", {218, 112, 214}},
-  {"mediumorchid", {186, 85, 211}},
-  {"darkorchid", {153, 50, 204}},
-  {"darkviolet", {148, 0, 211}},
-  {"blueviolet", {138, 43, 226}},
-  {"purple", {160, 32, 240}},
-  {"mediumpurple", {147, 112, 219}},
-  {"thistle", {216, 191, 216}},
-  {"snow1", {255, 250, 250}},
-  {"snow2", {238, 233, 233}},
-  {"snow3", {205, 201, 201}},
-  {"snow4", {139, 137, 137}},
-  {"seashell1", {255, 245, 238}},
-  {"seashell2", {238, 229, 222}},
-  {"seashell3", {205, 197, 191}},
-  {"seashell4", {139, 134, 130}},
-  {"antiquewhite1", {255, 239, 219}},
-  {"antiquewhite2", {238, 223, 204}},
-  {"antiquewhite3", {205, 192, 176}},
-  {"antiquewhite4", {139, 131, 120}},
-  {"bisque1", {255, 228, 196}},
-  {"bisque2", {238, 213, 183}},
-  {"bisque3", {205, 183, 158}},
-  {"bisque4", {139, 125, 107}},
-  {"peachpuff1", {255, 218, 185}},
-  {"peachpuff2", {238, 203, 173}},
-  {"peachpuff3", {205, 175, 149}},
-  {"peachpuff4", {139, 119, 101}},
-  {"navajowhite1", {255, 222, 173}},
-  {"navajowhite2", {238, 207, 161}},
-  {"navajowhite3", {205, 179, 139}},
-  {"navajowhite4", {139, 121, 94}},
-  {"lemonchiffon1", {255, 250, 205}},
-  {"lemonchiffon2", {238, 233, 191}},
-  {"lemonchiffon3", {205, 201, 165}},
-  {"lemonchiffon4", {139, 137, 112}},
-  {"cornsilk1", {255, 248, 220}},
-  {"cornsilk2", {238, 232, 205}},
-  {"cornsilk3", {205, 200, 177}},
-  {"cornsilk4", {139, 136, 120}},
-  {"ivory1", {255, 255, 240}},
-  {"ivory2", {238, 238, 224}},
-  {"ivory3", {205, 205, 193}},
-  {"ivory4", {139, 139, 131}},
-  {"honeydew1", {240, 255, 240}},
-  {"honeydew2", {224, 238, 224}},
-  {"honeydew3", {193, 205, 193}},
-  {"honeydew4", {131, 139, 131}},
-  {"lavenderblush1", {255, 240, 245}},
-  {"lavenderblush2", {238, 224, 229}},
-  {"lavenderblush3", {205, 193, 197}},
-  {"lavenderblush4", {139, 131, 134}},
-  {"mistyrose1", {255, 228, 225}},
-  {"mistyrose2", {238, 213, 210}},
-  {"mistyrose3", {205, 183, 181}},
-  {"mistyrose4", {139, 125, 123}},
-  {"azure1", {240, 255, 255}},
-  {"azure2", {224, 238, 238}},
-  {"azure3", {193, 205, 205}},
-  {"azure4", {131, 139, 139}},
-  {"slateblue1", {131, 111, 255}},
-  {"slateblue2", {122, 103, 238}},
-  {"slateblue3", {105, 89, 205}},
-  {"slateblue4", {71, 60, 139}},
-  {"royalblue1", {72, 118, 255}},
-  {"royalblue2", {67, 110, 238}},
-  {"royalblue3", {58, 95, 205}},
-  {"royalblue4", {39, 64, 139}},
-  {"blue1", {0, 0, 255}},
-  {"blue2", {0, 0, 238}},
-  {"blue3", {0, 0, 205}},
-  {"blue4", {0, 0, 139}},
-  {"dodgerblue1", {30, 144, 255}},
-  {"dodgerblue2", {28, 134, 238}},
-  {"dodgerblue3", {24, 116, 205}},
-  {"dodgerblue4", {16, 78, 139}},
-  {"steelblue1", {99, 184, 255}},
-  {"steelblue2", {92, 172, 238}},
-  {"steelblue3", {79, 148, 205}},
-  {"steelblue4", {54, 100, 139}},
-  {"deepskyblue1", {0, 191, 255}},
-  {"deepskyblue2", {0, 178, 238}},
-  {"deepskyblue3", {0, 154, 205}},
-  {"deepskyblue4", {0, 104, 139}},
-  {"skyblue1", {135, 206, 255}},
-  {"skyblue2", {126, 192, 238}},
-  {"skyblue3", {108, 166, 205}},
-  {"skyblue4", {74, 112, 139}},
-  {"lightskyblue1", {176, 226, 255}},
-  {"lightskyblue2", {164, 211, 238}},
-  {"lightskyblue3", {141, 182, 205}},
-  {"lightskyblue4", {96, 123, 139}},
-  {"slategray1", {198, 226, 255}},
-  {"slategray2", {185, 211, 238}},
-  {"slategray3", {159, 182, 205}},
-  {"slategray4", {108, 123, 139}},
-  {"lightsteelblue1", {202, 225, 255}},
-  {"lightsteelblue2", {188, 210, 238}},
-  {"lightsteelblue3", {162, 181, 205}},
-  {"lightsteelblue4", {110, 123, 139}},
-  {"lightblue1", {191, 239, 255}},
-  {"lightblue2", {178, 223, 238}},
-  {"lightblue3", {154, 192, 205}},
-  {"lightblue4", {104, 131, 139}},
-  {"lightcyan1", {224, 255, 255}},
-  {"lightcyan2", {209, 238, 238}},
-  {"lightcyan3", {180, 205, 205}},
-  {"lightcyan4", {122, 139, 139}},
-  {"paleturquoise1", {187, 255, 255}},
-  {"paleturquoise2", {174, 238, 238}},
-  {"paleturquoise3", {150, 205, 205}},
-  {"paleturquoise4", {102, 139, 139}},
-  {"cadetblue1", {152, 245, 255}},
-  {"cadetblue2", {142, 229, 238}},
-  {"cadetblue3", {122, 197, 205}},
-  {"cadetblue4", {83, 134, 139}},
-  {"turquoise1", {0, 245, 255}},
-  {"turquoise2", {0, 229, 238}},
-  {"turquoise3", {0, 197, 205}},
-  {"turquoise4", {0, 134, 139}},
-  {"cyan1", {0, 255, 255}},
-  {"cyan2", {0, 238, 238}},
-  {"cyan3", {0, 205, 205}},
-  {"cyan4", {0, 139, 139}},
-  {"darkslategray1", {151, 255, 255}},
-  {"darkslategray2", {141, 238, 238}},
-  {"darkslategray3", {121, 205, 205}},
-  {"darkslategray4", {82, 139, 139}},
-  {"aquamarine1", {127, 255, 212}},
-  {"aquamarine2", {118, 238, 198}},
-  {"aquamarine3", {102, 205, 170}},
-  {"aquamarine4", {69, 139, 116}},
-  {"darkseagreen1", {193, 255, 193}},
-  {"darkseagreen2", {180, 238, 180}},
-  {"darkseagreen3", {155, 205, 155}},
-  {"darkseagreen4", {105, 139, 105}},
-  {"seagreen1", {84, 255, 159}},
-  {"seagreen2", {78, 238, 148}},
-  {"seagreen3", {67, 205, 128}},
-  {"seagreen4", {46, 139, 87}},
-  {"palegreen1", {154, 255, 154}},
-  {"palegreen2", {144, 238, 144}},
-  {"palegreen3", {124, 205, 124}},
-  {"palegreen4", {84, 139, 84}},
-  {"springgreen1", {0, 255, 127}},
-  {"springgreen2", {0, 238, 118}},
-  {"springgreen3", {0, 205, 102}},
-  {"springgreen4", {0, 139, 69}},
-  {"green1", {0, 255, 0}},
-  {"green2", {0, 238, 0}},
-  {"green3", {0, 205, 0}},
-  {"green4", {0, 139, 0}},
-  {"chartreuse1", {127, 255, 0}},
-  {"chartreuse2", {118, 238, 0}},
-  {"chartreuse3", {102, 205, 0}},
-  {"chartreuse4", {69, 139, 0}},
-  {"olivedrab1", {192, 255, 62}},
-  {"olivedrab2", {179, 238, 58}},
-  {"olivedrab3", {154, 205, 50}},
-  {"olivedrab4", {105, 139, 34}},
-  {"darkolivegreen1", {202, 255, 112}},
-  {"darkolivegreen2", {188, 238, 104}},
-  {"darkolivegreen3", {162, 205, 90}},
-  {"darkolivegreen4", {110, 139, 61}},
-  {"khaki1", {255, 246, 143}},
-  {"khaki2", {238, 230, 133}},
-  {"khaki3", {205, 198, 115}},
-  {"khaki4", {139, 134, 78}},
-  {"lightgoldenrod1", {255, 236, 139}},
-  {"lightgoldenrod2", {238, 220, 130}},
-  {"lightgoldenrod3", {205, 190, 112}},
-  {"lightgoldenrod4", {139, 129, 76}},
-  {"lightyellow1", {255, 255, 224}},
-  {"lightyellow2", {238, 238, 209}},
-  {"lightyellow3", {205, 205, 180}},
-  {"lightyellow4", {139, 139, 122}},
-  {"yellow1", {255, 255, 0}},
-  {"yellow2", {238, 238, 0}},
-  {"yellow3", {205, 205, 0}},
-  {"yellow4", {139, 139, 0}},
-  {"gold1", {255, 215, 0}},
-  {"gold2", {238, 201, 0}},
-  {"gold3", {205, 173, 0}},
-  {"gold4", {139, 117, 0}},
-  {"goldenrod1", {255, 193, 37}},
-  {"goldenrod2", {238, 180, 34}},
-  {"goldenrod3", {205, 155, 29}},
-  {"goldenrod4", {139, 105, 20}},
-  {"darkgoldenrod1", {255, 185, 15}},
-  {"darkgoldenrod2", {238, 173, 14}},
-  {"darkgoldenrod3", {205, 149, 12}},
-  {"darkgoldenrod4", {139, 101, 8}},
-  {"rosybrown1", {255, 193, 193}},
-  {"rosybrown2", {238, 180, 180}},
-  {"rosybrown3", {205, 155, 155}},
-  {"rosybrown4", {139, 105, 105}},
-  {"indianred1", {255, 106, 106}},
-  {"indianred2", {238, 99, 99}},
-  {"indianred3", {205, 85, 85}},
-  {"indianred4", {139, 58, 58}},
-  {"sienna1", {255, 130, 71}},
-  {"sienna2", {238, 121, 66}},
-  {"sienna3", {205, 104, 57}},
-  {"sienna4", {139, 71, 38}},
-  {"burlywood1", {255, 211, 155}},
-  {"burlywood2", {238, 197, 145}},
-  {"burlywood3", {205, 170, 125}},
-  {"burlywood4", {139, 115, 85}},
-  {"wheat1", {255, 231, 186}},
-  {"wheat2", {238, 216, 174}},
-  {"wheat3", {205, 186, 150}},
-  {"wheat4", {139, 126, 102}},
-  {"tan1", {255, 165, 79}},
-  {"tan2", {238, 154, 73}},
-  {"tan3", {205, 133, 63}},
-  {"tan4", {139, 90, 43}},
-  {"chocolate1", {255, 127, 36}},
-  {"chocolate2", {238, 118, 33}},
-  {"chocolate3", {205, 102, 29}},
-  {"chocolate4", {139, 69, 19}},
-  {"firebrick1", {255, 48, 48}},
-  {"firebrick2", {238, 44, 44}},
-  {"firebrick3", {205, 38, 38}},
-  {"firebrick4", {139, 26, 26}},
-  {"brown1", {255, 64, 64}},
-  {"brown2", {238, 59, 59}},
-  {"brown3", {205, 51, 51}},
-  {"brown4", {139, 35, 35}},
-  {"salmon1", {255, 140, 105}},
-  {"salmon2", {238, 130, 98}},
-  {"salmon3", {205, 112, 84}},
-  {"salmon4", {139, 76, 57}},
-  {"lightsalmon1", {255, 160, 122}},
-  {"lightsalmon2", {238, 149, 114}},
-  {"lightsalmon3", {205, 129, 98}},
-  {"lightsalmon4", {139, 87, 66}},
-  {"orange1", {255, 165, 0}},
-  {"orange2", {238, 154, 0}},
-  {"orange3", {205, 133, 0}},
-  {"orange4", {139, 90, 0}},
-  {"darkorange1", {255, 127, 0}},
-  {"darkorange2", {238, 118, 0}},
-  {"darkorange3", {205, 102, 0}},
-  {"darkorange4", {139, 69, 0}},
-  {"coral1", {255, 114, 86}},
-  {"coral2", {238, 106, 80}},
-  {"coral3", {205, 91, 69}},
-  {"coral4", {139, 62, 47}},
-  {"tomato1", {255, 99, 71}},
-  {"tomato2", {238, 92, 66}},
-  {"tomato3", {205, 79, 57}},
-  {"tomato4", {139, 54, 38}},
-  {"orangered1", {255, 69, 0}},
-  {"orangered2", {238, 64, 0}},
-  {"orangered3", {205, 55, 0}},
-  {"orangered4", {139, 37, 0}},
-  {"red1", {255, 0, 0}},
-  {"red2", {238, 0, 0}},
-  {"red3", {205, 0, 0}},
-  {"red4", {139, 0, 0}},
-  {"deeppink1", {255, 20, 147}},
-  {"deeppink2", {238, 18, 137}},
-  {"deeppink3", {205, 16, 118}},
-  {"deeppink4", {139, 10, 80}},
-  {"hotpink1", {255, 110, 180}},
-  {"hotpink2", {238, 106, 167}},
-  {"hotpink3", {205, 96, 144}},
-  {"hotpink4", {139, 58, 98}},
-  {"pink1", {255, 181, 197}},
-  {"pink2", {238, 169, 184}},
-  {"pink3", {205, 145, 158}},
-  {"pink4", {139, 99, 108}},
-  {"lightpink1", {255, 174, 185}},
-  {"lightpink2", {238, 162, 173}},
-  {"lightpink3", {205, 140, 149}},
-  {"lightpink4", {139, 95, 101}},
-  {"palevioletred1", {255, 130, 171}},
-  {"palevioletred2", {238, 121, 159}},
-  {"palevioletred3", {205, 104, 137}},
-  {"palevioletred4", {139, 71, 93}},
-  {"maroon1", {255, 52, 179}},
-  {"maroon2", {238, 48, 167}},
-  {"maroon3", {205, 41, 144}},
-  {"maroon4", {139, 28, 98}},
-  {"violetred1", {255, 62, 150}},
-  {"violetred2", {238, 58, 140}},
-  {"violetred3", {205, 50, 120}},
-  {"violetred4", {139, 34, 82}},
-  {"magenta1", {255, 0, 255}},
-  {"magenta2", {238, 0, 238}},
-  {"magenta3", {205, 0, 205}},
-  {"magenta4", {139, 0, 139}},
-  {"orchid1", {255, 131, 250}},
-  {"orchid2", {238, 122, 233}},
-  {"orchid3", {205, 105, 201}},
-  {"orchid4", {139, 71, 137}},
-  {"plum1", {255, 187, 255}},
-  {"plum2", {238, 174, 238}},
-  {"plum3", {205, 150, 205}},
-  {"plum4", {139, 102, 139}},
-  {"mediumorchid1", {224, 102, 255}},
-  {"mediumorchid2", {209, 95, 238}},
-  {"mediumorchid3", {180, 82, 205}},
-  {"mediumorchid4", {122, 55, 139}},
-  {"darkorchid1", {191, 62, 255}},
-  {"darkorchid2", {178, 58, 238}},
-  {"darkorchid3", {154, 50, 205}},
-  {"darkorchid4", {104, 34, 139}},
-  {"purple1", {155, 48, 255}},
-  {"purple2", {145, 44, 238}},
-  {"purple3", {125, 38, 205}},
-  {"purple4", {85, 26, 139}},
-  {"mediumpurple1", {171, 130, 255}},
-  {"mediumpurple2", {159, 121, 238}},
-  {"mediumpurple3", {137, 104, 205}},
-  {"mediumpurple4", {93, 71, 139}},
-  {"thistle1", {255, 225, 255}},
-  {"thistle2", {238, 210, 238}},
-  {"thistle3", {205, 181, 205}},
-  {"thistle4", {139, 123, 139}},
-  {"gray0", {0, 0, 0}},
-  {"grey0", {0, 0, 0}},
-  {"gray1", {3, 3, 3}},
-  {"grey1", {3, 3, 3}},
-  {"gray2", {5, 5, 5}},
-  {"grey2", {5, 5, 5}},
-  {"gray3", {8, 8, 8}},
-  {"grey3", {8, 8, 8}},
-  {"gray4", {10, 10, 10}},
-  {"grey4", {10, 10, 10}},
-  {"gray5", {13, 13, 13}},
-  {"grey5", {13, 13, 13}},
-  {"gray6", {15, 15, 15}},
-  {"grey6", {15, 15, 15}},
-  {"gray7", {18, 18, 18}},
-  {"grey7", {18, 18, 18}},
-  {"gray8", {20, 20, 20}},
-  {"grey8", {20, 20, 20}},
-  {"gray9", {23, 23, 23}},
-  {"grey9", {23, 23, 23}},
-  {"gray10", {26, 26, 26}},
-  {"grey10", {26, 26, 26}},
-  {"gray11", {28, 28, 28}},
-  {"grey11", {28, 28, 28}},
-  {"gray12", {31, 31, 31}},
-  {"grey12", {31, 31, 31}},
-  {"gray13", {33, 33, 33}},
-  {"grey13", {33, 33, 33}},
-  {"gray14", {36, 36, 36}},
-  {"grey14", {36, 36, 36}},
-  {"gray15", {38, 38, 38}},
-  {"grey15", {38, 38, 38}},
-  {"gray16", {41, 41, 41}},
-  {"grey16", {41, 41, 41}},
-  {"gray17", {43, 43, 43}},
-  {"grey17", {43, 43, 43}},
-  {"gray18", {46, 46, 46}},
-  {"grey18", {46, 46, 46}},
-  {"gray19", {48, 48, 48}},
-  {"grey19", {48, 48, 48}},
-  {"gray20", {51, 51, 51}},
-  {"grey20", {51, 51, 51}},
-  {"gray21", {54, 54, 54}},
-  {"grey21", {54, 54, 54}},
-  {"gray22", {56, 56, 56}},
-  {"grey22", {56, 56, 56}},
-  {"gray23", {59, 59, 59}},
-  {"grey23", {59, 59, 59}},
-  {"gray24", {61, 61, 61}},
-  {"grey24", {61, 61, 61}},
-  {"gray25", {64, 64, 64}},
-  {"grey25", {64, 64, 64}},
-  {"gray26", {66, 66, 66}},
-  {"grey26", {66, 66, 66}},
-  {"gray27", {69, 69, 69}},
-  {"grey27", {69, 69, 69}},
-  {"gray28", {71, 71, 71}},
-  {"grey28", {71, 71, 71}},
-  {"gray29", {74, 74, 74}},
-  {"grey29", {74, 74, 74}},
-  {"gray30", {77, 77, 77}},
-  {"grey30", {77, 77, 77}},
-  {"gray31", {79, 79, 79}},
-  {"grey31", {79, 79, 79}},
-  {"gray32", {82, 82, 82}},
-  {"grey32", {82, 82, 82}},
-  {"gray33", {84, 84, 84}},
-  {"grey33", {84, 84, 84}},
-  {"gray34", {87, 87, 87}},
-  {"grey34", {87, 87, 87}},
-  {"gray35", {89, 89, 89}},
-  {"grey35", {89, 89, 89}},
-  {"gray36", {92, 92, 92}},
-  {"grey36", {92, 92, 92}},
-  {"gray37", {94, 94, 94}},
-  {"grey37", {94, 94, 94}},
-  {"gray38", {97, 97, 97}},
-  {"grey38", {97, 97, 97}},
-  {"gray39", {99, 99, 99}},
-  {"grey39", {99, 99, 99}},
-  {"gray40", {102, 102, 102}},
-  {"grey40", {102, 102, 102}},
-  {"gray41", {105, 105, 105}},
-  {"grey41", {105, 105, 105}},
-  {"gray42", {107, 107, 107}},
-  {"grey42", {107, 107, 107}},
-  {"gray43", {110, 110, 110}},
-  {"grey43", {110, 110, 110}},
-  {"gray44", {112, 112, 112}},
-  {"grey44", {112, 112, 112}},
-  {"gray45", {115, 115, 115}},
-  {"grey45", {115, 115, 115}},
-  {"gray46", {117, 117, 117}},
-  {"grey46", {117, 117, 117}},
-  {"gray47", {120, 120, 120}},
-  {"grey47", {120, 120, 120}},
-  {"gray48", {122, 122, 122}},
-  {"grey48", {122, 122, 122}},
-  {"gray49", {125, 125, 125}},
-  {"grey49", {125, 125, 125}},
-  {"gray50", {127, 127, 127}},
-  {"grey50", {127, 127, 127}},
-  {"gray51", {130, 130, 130}},
-  {"grey51", {130, 130, 130}},
-  {"gray52", {133, 133, 133}},
-  {"grey52", {133, 133, 133}},
-  {"gray53", {135, 135, 135}},
-  {"grey53", {135, 135, 135}},
-  {"gray54", {138, 138, 138}},
-  {"grey54", {138, 138, 138}},
-  {"gray55", {140, 140, 140}},
-  {"grey55", {140, 140, 140}},
-  {"gray56", {143, 143, 143}},
-  {"grey56", {143, 143, 143}},
-  {"gray57", {145, 145, 145}},
-  {"grey57", {145, 145, 145}},
-  {"gray58", {148, 148, 148}},
-  {"grey58", {148, 148, 148}},
-  {"gray59", {150, 150, 150}},
-  {"grey59", {150, 150, 150}},
-  {"gray60", {153, 153, 153}},
-  {"grey60", {153, 153, 153}},
-  {"gray61", {156, 156, 156}},
-  {"grey61", {156, 156, 156}},
-  {"gray62", {158, 158, 158}},
-  {"grey62", {158, 158, 158}},
-  {"gray63", {161, 161, 161}},
-  {"grey63", {161, 161, 161}},
-  {"gray64", {163, 163, 163}},
-  {"grey64", {163, 163, 163}},
-  {"gray65", {166, 166, 166}},
-  {"grey65", {166, 166, 166}},
-  {"gray66", {168, 168, 168}},
-  {"grey66", {168, 168, 168}},
-  {"gray67", {171, 171, 171}},
-  {"grey67", {171, 171, 171}},
-  {"gray68", {173, 173, 173}},
-  {"grey68", {173, 173, 173}},
-  {"gray69", {176, 176, 176}},
-  {"grey69", {176, 176, 176}},
-  {"gray70", {179, 179, 179}},
-  {"grey70", {179, 179, 179}},
-  {"gray71", {181, 181, 181}},
-  {"grey71", {181, 181, 181}},
-  {"gray72", {184, 184, 184}},
-  {"grey72", {184, 184, 184}},
-  {"gray73", {186, 186, 186}},
-  {"grey73", {186, 186, 186}},
-  {"gray74", {189, 189, 189}},
-  {"grey74", {189, 189, 189}},
-  {"gray75", {191, 191, 191}},
-  {"grey75", {191, 191, 191}},
-  {"gray76", {194, 194, 194}},
-  {"grey76", {194, 194, 194}},
-  {"gray77", {196, 196, 196}},
-  {"grey77", {196, 196, 196}},
-  {"gray78", {199, 199, 199}},
-  {"grey78", {199, 199, 199}},
-  {"gray79", {201, 201, 201}},
-  {"grey79", {201, 201, 201}},
-  {"gray80", {204, 204, 204}},
-  {"grey80", {204, 204, 204}},
-  {"gray81", {207, 207, 207}},
-  {"grey81", {207, 207, 207}},
-  {"gray82", {209, 209, 209}},
-  {"grey82", {209, 209, 209}},
-  {"gray83", {212, 212, 212}},
-  {"grey83", {212, 212, 212}},
-  {"gray84", {214, 214, 214}},
-  {"grey84", {214, 214, 214}},
-  {"gray85", {217, 217, 217}},
-  {"grey85", {217, 217, 217}},
-  {"gray86", {219, 219, 219}},
-  {"grey86", {219, 219, 219}},
-  {"gray87", {222, 222, 222}},
-  {"grey87", {222, 222, 222}},
-  {"gray88", {224, 224, 224}},
-  {"grey88", {224, 224, 224}},
-  {"gray89", {227, 227, 227}},
-  {"grey89", {227, 227, 227}},
-  {"gray90", {229, 229, 229}},
-  {"grey90", {229, 229, 229}},
-  {"gray91", {232, 232, 232}},
-  {"grey91", {232, 232, 232}},
-  {"gray92", {235, 235, 235}},
-  {"grey92", {235, 235, 235}},
-  {"gray93", {237, 237, 237}},
-  {"grey93", {237, 237, 237}},
-  {"gray94", {240, 240, 240}},
-  {"grey94", {240, 240, 240}},
-  {"gray95", {242, 242, 242}},
-  {"grey95", {242, 242, 242}},
-  {"gray96", {245, 245, 245}},
-  {"grey96", {245, 245, 245}},
-  {"gray97", {247, 247, 247}},
-  {"grey97", {247, 247, 247}},
-  {"gray98", {250, 250, 250}},
-  {"grey98", {250, 250, 250}},
-  {"gray99", {252, 252, 252}},
-  {"grey99", {252, 252, 252}},
-  {"gray100", {255, 255, 255}},
-  {"grey100", {255, 255, 255}},
-  {"darkgrey", {169, 169, 169}},
-  {"darkgray", {169, 169, 169}},
-  {"darkblue", {0, 0, 139}},
-  {"darkcyan", {0, 139, 139}},
-  {"darkmagenta", {139, 0, 139}},
-  {"darkred", {139, 0, 0}},
-  {"lightgreen", {144, 238, 144}}
-};
\ No newline at end of file
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "rgb.h"
+
+struct X11Colour {
+  std::string_view name;
+  Rgb rgb;
+
+  // Takes the length from the array type rather than scanning for the null.
+  template <std::size_t N>
+  constexpr X11Colour(const char (&name)[N], Rgb rgb) : name(name, N - 1),
+    rgb(rgb)
+  {
+
+  }
+};
+
+inline constexpr X11Colour x11_colours[] = {
+  {"snow", {255, 250, 250}},
+  {"ghost", {248, 248, 255}},
+  {"ghostwhite", {248, 248, 255}},
+  {"white", {255, 255, 255}},
+  {"whitesmoke", {245, 245, 245}},
+  {"gainsboro", {220, 220, 220}},
+  {"floral", {255, 250, 240}},
+  {"floralwhite", {255, 250, 240}},
+  {"old", {253, 245, 230}},
+  {"oldlace", {253, 245, 230}},
+  {"linen", {250, 240, 230}},
+  {"antique", {250, 235, 215}},
+  {"antiquewhite", {250, 235, 215}},
+  {"papaya", {255, 239, 213}},
+  {"papayawhip", {255, 239, 213}},
+  {"blanched", {255, 235, 205}},
+  {"blanchedalmond", {255, 235, 205}},
+  {"bisque", {255, 228, 196}},
+  {"peach", {255, 218, 185}},
+  {"peachpuff", {255, 218, 185}},
+  {"navajo", {255, 222, 173}},
+  {"navajowhite", {255, 222, 173}},
+  {"moccasin", {255, 228, 181}},
+  {"cornsilk", {255, 248, 220}},
+  {"ivory", {255, 255, 240}},
+  {"lemon", {255, 250, 205}},
+  {"lemonchiffon", {255, 250, 205}},
+  {"seashell", {255, 245, 238}},
+  {"honeydew", {240, 255, 240}},
+  {"mint", {245, 255, 250}},
+  {"mintcream", {245, 255, 250}},
+  {"azure", {240, 255, 255}},
+  {"alice", {240, 248, 255}},
+  {"aliceblue", {240, 248, 255}},
+  {"lavender", {255, 240, 245}},
+  {"lavenderblush", {255, 240, 245}},
+  {"misty", {255, 228, 225}},
+  {"mistyrose", {255, 228, 225}},
+  {"black", {0, 0, 0}},
+  {"dark", {139, 0, 0}},
+  {"darkslategray", {47, 79, 79}},
+  {"darkslategrey", {47, 79, 79}},
+  {"dim", {105, 105, 105}},
+  {"dimgray", {105, 105, 105}},
+  {"dimgrey", {105, 105, 105}},
+  {"slate", {106, 90, 205}},
+  {"slategray", {112, 128, 144}},
+  {"slategrey", {112, 128, 144}},
+  {"light", {144, 238, 144}},
+  {"lightslategray", {119, 136, 153}},
+  {"lightslategrey", {119, 136, 153}},
+  {"gray", {190, 190, 190}},
+  {"grey", {190, 190, 190}},
+  {"lightgrey", {211, 211, 211}},
+  {"lightgray", {211, 211, 211}},
+  {"midnight", {25, 25, 112}},
+  {"midnightblue", {25, 25, 112}},
+  {"navy", {0, 0, 128}},
+  {"navyblue", {0, 0, 128}},
+  {"cornflower", {100, 149, 237}},
+  {"cornflowerblue", {100, 149, 237}},
+  {"darkslateblue", {72, 61, 139}},
+  {"slateblue", {106, 90, 205}},
+  {"medium", {147, 112, 219}},
+  {"mediumslateblue", {123, 104, 238}},
+  {"lightslateblue", {132, 112, 255}},
+  {"mediumblue", {0, 0, 205}},
+  {"royal", {65, 105, 225}},
+  {"royalblue", {65, 105, 225}},
+  {"blue", {138, 43, 226}},
+  {"dodger", {30, 144, 255}},
+  {"dodgerblue", {30, 144, 255}},
+  {"deep", {255, 20, 147}},
+  {"deepskyblue", {0, 191, 255}},
+  {"sky", {135, 206, 235}},
+  {"skyblue", {135, 206, 235}},
+  {"lightskyblue", {135, 206, 250}},
+  {"steel", {70, 130, 180}},
+  {"steelblue", {70, 130, 180}},
+  {"lightsteelblue", {176, 196, 222}},
+  {"lightblue", {173, 216, 230}},
+  {"powder", {176, 224, 230}},
+  {"powderblue", {176, 224, 230}},
+  {"pale", {219, 112, 147}},
+  {"paleturquoise", {175, 238, 238}},
+  {"darkturquoise", {0, 206, 209}},
+  {"mediumturquoise", {72, 209, 204}},
+  {"turquoise", {64, 224, 208}},
+  {"cyan", {0, 255, 255}},
+  {"lightcyan", {224, 255, 255}},
+  {"cadet", {95, 158, 160}},
+  {"cadetblue", {95, 158, 160}},
+  {"mediumaquamarine", {102, 205, 170}},
+  {"aquamarine", {127, 255, 212}},
+  {"darkgreen", {0, 100, 0}},
+  {"darkolivegreen", {85, 107, 47}},
+  {"darkseagreen", {143, 188, 143}},
+  {"sea", {46, 139, 87}},
+  {"seagreen", {46, 139, 87}},
+  {"mediumseagreen", {60, 179, 113}},
+  {"lightseagreen", {32, 178, 170}},
+  {"palegreen", {152, 251, 152}},
+  {"spring", {0, 255, 127}},
+  {"springgreen", {0, 255, 127}},
+  {"lawn", {124, 252, 0}},
+  {"lawngreen", {124, 252, 0}},
+  {"green", {173, 255, 47}},
+  {"chartreuse", {127, 255, 0}},
+  {"mediumspringgreen", {0, 250, 154}},
+  {"greenyellow", {173, 255, 47}},
+  {"lime", {50, 205, 50}},
+  {"limegreen", {50, 205, 50}},
+  {"yellow", {255, 255, 0}},
+  {"yellowgreen", {154, 205, 50}},
+  {"forest", {34, 139, 34}},
+  {"forestgreen", {34, 139, 34}},
+  {"olive", {107, 142, 35}},
+  {"olivedrab", {107, 142, 35}},
+  {"darkkhaki", {189, 183, 107}},
+  {"khaki", {240, 230, 140}},
+  {"palegoldenrod", {238, 232, 170}},
+  {"lightgoldenrodyellow", {250, 250, 210}},
+  {"lightyellow", {255, 255, 224}},
+  {"gold", {255, 215, 0}},
+  {"lightgoldenrod", {238, 221, 130}},
+  {"goldenrod", {218, 165, 32}},
+  {"darkgoldenrod", {184, 134, 11}},
+  {"rosy", {188, 143, 143}},
+  {"rosybrown", {188, 143, 143}},
+  {"indian", {205, 92, 92}},
+  {"indianred", {205, 92, 92}},
+  {"saddle", {139, 69, 19}},
+  {"saddlebrown", {139, 69, 19}},
+  {"sienna", {160, 82, 45}},
+  {"peru", {205, 133, 63}},
+  {"burlywood", {222, 184, 135}},
+  {"beige", {245, 245, 220}},
+  {"wheat", {245, 222, 179}},
+  {"sandy", {244, 164, 96}},
+  {"sandybrown", {244, 164, 96}},
+  {"tan", {210, 180, 140}},
+  {"chocolate", {210, 105, 30}},
+  {"firebrick", {178, 34, 34}},
+  {"brown", {165, 42, 42}},
+  {"darksalmon", {233, 150, 122}},
+  {"salmon", {250, 128, 114}},
+  {"lightsalmon", {255, 160, 122}},
+  {"orange", {255, 69, 0}},
+  {"darkorange", {255, 140, 0}},
+  {"coral", {255, 127, 80}},
+  {"lightcoral", {240, 128, 128}},
+  {"tomato", {255, 99, 71}},
+  {"orangered", {255, 69, 0}},
+  {"red", {255, 0, 0}},
+  {"hot", {255, 105, 180}},
+  {"hotpink", {255, 105, 180}},
+  {"deeppink", {255, 20, 147}},
+  {"pink", {255, 192, 203}},
+  {"lightpink", {255, 182, 193}},
+  {"palevioletred", {219, 112, 147}},
+  {"maroon", {176, 48, 96}},
+  {"mediumvioletred", {199, 21, 133}},
+  {"violet", {238, 130, 238}},
+  {"violetred", {208, 32, 144}},
+  {"magenta", {255, 0, 255}},
+  {"plum", {221, 160, 221}},
+  {"orchid", {218, 112, 214}},
+  {"mediumorchid", {186, 85, 211}},
+  {"darkorchid", {153, 50, 204}},
+  {"darkviolet", {148, 0, 211}},
+  {"blueviolet", {138, 43, 226}},
+  {"purple", {160, 32, 240}},
+  {"mediumpurple", {147, 112, 219}},
+  {"thistle", {216, 191, 216}},
+  {"snow1", {255, 250, 250}},
+  {"snow2", {238, 233, 233}},
+  {"snow3", {205, 201, 201}},
+  {"snow4", {139, 137, 137}},
+  {"seashell1", {255, 245, 238}},
+  {"seashell2", {238, 229, 222}},
+  {"seashell3", {205, 197, 191}},
+  {"seashell4", {139, 134, 130}},
+  {"antiquewhite1", {255, 239, 219}},
+  {"antiquewhite2", {238, 223, 204}},
+  {"antiquewhite3", {205, 192, 176}},
+  {"antiquewhite4", {139, 131, 120}},
+  {"bisque1", {255, 228, 196}},
+  {"bisque2", {238, 213, 183}},
+  {"bisque3", {205, 183, 158}},
+  {"bisque4", {139, 125, 107}},
+  {"peachpuff1", {255, 218, 185}},
+  {"peachpuff2", {238, 203, 173}},
+  {"peachpuff3", {205, 175, 149}},
+  {"peachpuff4", {139, 119, 101}},
+  {"navajowhite1", {255, 222, 173}},
+  {"navajowhite2", {238, 207, 161}},
+  {"navajowhite3", {205, 179, 139}},
+  {"navajowhite4", {139, 121, 94}},
+  {"lemonchiffon1", {255, 250, 205}},
+  {"lemonchiffon2", {238, 233, 191}},
+  {"lemonchiffon3", {205, 201, 165}},
+  {"lemonchiffon4", {139, 137, 112}},
+  {"cornsilk1", {255, 248, 220}},
+  {"cornsilk2", {238, 232, 205}},
+  {"cornsilk3", {205, 200, 177}},
+  {"cornsilk4", {139, 136, 120}},
+  {"ivory1", {255, 255, 240}},
+  {"ivory2", {238, 238, 224}},
+  {"ivory3", {205, 205, 193}},
+  {"ivory4", {139, 139, 131}},
+  {"honeydew1", {240, 255, 240}},
+  {"honeydew2", {224, 238, 224}},
+  {"honeydew3", {193, 205, 193}},
+  {"honeydew4", {131, 139, 131}},
+  {"lavenderblush1", {255, 240, 245}},
+  {"lavenderblush2", {238, 224, 229}},
+  {"lavenderblush3", {205, 193, 197}},
+  {"lavenderblush4", {139, 131, 134}},
+  {"mistyrose1", {255, 228, 225}},
+  {"mistyrose2", {238, 213, 210}},
+  {"mistyrose3", {205, 183, 181}},
+  {"mistyrose4", {139, 125, 123}},
+  {"azure1", {240, 255, 255}},
+  {"azure2", {224, 238, 238}},
+  {"azure3", {193, 205, 205}},
+  {"azure4", {131, 139, 139}},
+  {"slateblue1", {131, 111, 255}},
+  {"slateblue2", {122, 103, 238}},
+  {"slateblue3", {105, 89, 205}},
+  {"slateblue4", {71, 60, 139}},
+  {"royalblue1", {72, 118, 255}},
+  {"royalblue2", {67, 110, 238}},
+  {"royalblue3", {58, 95, 205}},
+  {"royalblue4", {39, 64, 139}},
+  {"blue1", {0, 0, 255}},
+  {"blue2", {0, 0, 238}},
+  {"blue3", {0, 0, 205}},
+  {"blue4", {0, 0, 139}},
+  {"dodgerblue1", {30, 144, 255}},
+  {"dodgerblue2", {28, 134, 238}},
+  {"dodgerblue3", {24, 116, 205}},
+  {"dodgerblue4", {16, 78, 139}},
+  {"steelblue1", {99, 184, 255}},
+  {"steelblue2", {92, 172, 238}},
+  {"steelblue3", {79, 148, 205}},
+  {"steelblue4", {54, 100, 139}},
+  {"deepskyblue1", {0, 191, 255}},
+  {"deepskyblue2", {0, 178, 238}},
+  {"deepskyblue3", {0, 154, 205}},
+  {"deepskyblue4", {0, 104, 139}},
+  {"skyblue1", {135, 206, 255}},
+  {"skyblue2", {126, 192, 238}},
+  {"skyblue3", {108, 166, 205}},
+  {"skyblue4", {74, 112, 139}},
+  {"lightskyblue1", {176, 226, 255}},
+  {"lightskyblue2", {164, 211, 238}},
+  {"lightskyblue3", {141, 182, 205}},
+  {"lightskyblue4", {96, 123, 139}},
+  {"slategray1", {198, 226, 255}},
+  {"slategray2", {185, 211, 238}},
+  {"slategray3", {159, 182, 205}},
+  {"slategray4", {108, 123, 139}},
+  {"lightsteelblue1", {202, 225, 255}},
+  {"lightsteelblue2", {188, 210, 238}},
+  {"lightsteelblue3", {162, 181, 205}},
+  {"lightsteelblue4", {110, 123, 139}},
+  {"lightblue1", {191, 239, 255}},
+  {"lightblue2", {178, 223, 238}},
+  {"lightblue3", {154, 192, 205}},
+  {"lightblue4", {104, 131, 139}},
+  {"lightcyan1", {224, 255, 255}},
+  {"lightcyan2", {209, 238, 238}},
+  {"lightcyan3", {180, 205, 205}},
+  {"lightcyan4", {122, 139, 139}},
+  {"paleturquoise1", {187, 255, 255}},
+  {"paleturquoise2", {174, 238, 238}},
+  {"paleturquoise3", {150, 205, 205}},
+  {"paleturquoise4", {102, 139, 139}},
+  {"cadetblue1", {152, 245, 255}},
+  {"cadetblue2", {142, 229, 238}},
+  {"cadetblue3", {122, 197, 205}},
+  {"cadetblue4", {83, 134, 139}},
+  {"turquoise1", {0, 245, 255}},
+  {"turquoise2", {0, 229, 238}},
+  {"turquoise3", {0, 197, 205}},
+  {"turquoise4", {0, 134, 139}},
+  {"cyan1", {0, 255, 255}},
+  {"cyan2", {0, 238, 238}},
+  {"cyan3", {0, 205, 205}},
+  {"cyan4", {0, 139, 139}},
+  {"darkslategray1", {151, 255, 255}},
+  {"darkslategray2", {141, 238, 238}},
+  {"darkslategray3", {121, 205, 205}},
+  {"darkslategray4", {82, 139, 139}},
+  {"aquamarine1", {127, 255, 212}},
+  {"aquamarine2", {118, 238, 198}},
+  {"aquamarine3", {102, 205, 170}},
+  {"aquamarine4", {69, 139, 116}},
+  {"darkseagreen1", {193, 255, 193}},
+  {"darkseagreen2", {180, 238, 180}},
+  {"darkseagreen3", {155, 205, 155}},
+  {"darkseagreen4", {105, 139, 105}},
+  {"seagreen1", {84, 255, 159}},
+  {"seagreen2", {78, 238, 148}},
+  {"seagreen3", {67, 205, 128}},
+  {"seagreen4", {46, 139, 87}},
+  {"palegreen1", {154, 255, 154}},
+  {"palegreen2", {144, 238, 144}},
+  {"palegreen3", {124, 205, 124}},
+  {"palegreen4", {84, 139, 84}},
+  {"springgreen1", {0, 255, 127}},
+  {"springgreen2", {0, 238, 118}},
+  {"springgreen3", {0, 205, 102}},
+  {"springgreen4", {0, 139, 69}},
+  {"green1", {0, 255, 0}},
+  {"green2", {0, 238, 0}},
+  {"green3", {0, 205, 0}},
+  {"green4", {0, 139, 0}},
+  {"chartreuse1", {127, 255, 0}},
+  {"chartreuse2", {118, 238, 0}},
+  {"chartreuse3", {102, 205, 0}},
+  {"chartreuse4", {69, 139, 0}},
+  {"olivedrab1", {192, 255, 62}},
+  {"olivedrab2", {179, 238, 58}},
+  {"olivedrab3", {154, 205, 50}},
+  {"olivedrab4", {105, 139, 34}},
+  {"darkolivegreen1", {202, 255, 112}},
+  {"darkolivegreen2", {188, 238, 104}},
+  {"darkolivegreen3", {162, 205, 90}},
+  {"darkolivegreen4", {110, 139, 61}},
+  {"khaki1", {255, 246, 143}},
+  {"khaki2", {238, 230, 133}},
+  {"khaki3", {205, 198, 115}},
+  {"khaki4", {139, 134, 78}},
+  {"lightgoldenrod1", {255, 236, 139}},
+  {"lightgoldenrod2", {238, 220, 130}},
+  {"lightgoldenrod3", {205, 190, 112}},
+  {"lightgoldenrod4", {139, 129, 76}},
+  {"lightyellow1", {255, 255, 224}},
+  {"lightyellow2", {238, 238, 209}},
+  {"lightyellow3", {205, 205, 180}},
+  {"lightyellow4", {139, 139, 122}},
+  {"yellow1", {255, 255, 0}},
+  {"yellow2", {238, 238, 0}},
+  {"yellow3", {205, 205, 0}},
+  {"yellow4", {139, 139, 0}},
+  {"gold1", {255, 215, 0}},
+  {"gold2", {238, 201, 0}},
+  {"gold3", {205, 173, 0}},
+  {"gold4", {139, 117, 0}},
+  {"goldenrod1", {255, 193, 37}},
+  {"goldenrod2", {238, 180, 34}},
+  {"goldenrod3", {205, 155, 29}},
+  {"goldenrod4", {139, 105, 20}},
+  {"darkgoldenrod1", {255, 185, 15}},
+  {"darkgoldenrod2", {238, 173, 14}},
+  {"darkgoldenrod3", {205, 149, 12}},
+  {"darkgoldenrod4", {139, 101, 8}},
+  {"rosybrown1", {255, 193, 193}},
+  {"rosybrown2", {238, 180, 180}},
+  {"rosybrown3", {205, 155, 155}},
+  {"rosybrown4", {139, 105, 105}},
+  {"indianred1", {255, 106, 106}},
+  {"indianred2", {238, 99, 99}},
+  {"indianred3", {205, 85, 85}},
+  {"indianred4", {139, 58, 58}},
+  {"sienna1", {255, 130, 71}},
+  {"sienna2", {238, 121, 66}},
+  {"sienna3", {205, 104, 57}},
+  {"sienna4", {139, 71, 38}},
+  {"burlywood1", {255, 211, 155}},
+  {"burlywood2", {238, 197, 145}},
+  {"burlywood3", {205, 170, 125}},
+  {"burlywood4", {139, 115, 85}},
+  {"wheat1", {255, 231, 186}},
+  {"wheat2", {238, 216, 174}},
+  {"wheat3", {205, 186, 150}},
+  {"wheat4", {139, 126, 102}},
+  {"tan1", {255, 165, 79}},
+  {"tan2", {238, 154, 73}},
+  {"tan3", {205, 133, 63}},
+  {"tan4", {139, 90, 43}},
+  {"chocolate1", {255, 127, 36}},
+  {"chocolate2", {238, 118, 33}},
+  {"chocolate3", {205, 102, 29}},
+  {"chocolate4", {139, 69, 19}},
+  {"firebrick1", {255, 48, 48}},
+  {"firebrick2", {238, 44, 44}},
+  {"firebrick3", {205, 38, 38}},
+  {"firebrick4", {139, 26, 26}},
+  {"brown1", {255, 64, 64}},
+  {"brown2", {238, 59, 59}},
+  {"brown3", {205, 51, 51}},
+  {"brown4", {139, 35, 35}},
+  {"salmon1", {255, 140, 105}},
+  {"salmon2", {238, 130, 98}},
+  {"salmon3", {205, 112, 84}},
+  {"salmon4", {139, 76, 57}},
+  {"lightsalmon1", {255, 160, 122}},
+  {"lightsalmon2", {238, 149, 114}},
+  {"lightsalmon3", {205, 129, 98}},
+  {"lightsalmon4", {139, 87, 66}},
+  {"orange1", {255, 165, 0}},
+  {"orange2", {238, 154, 0}},
+  {"orange3", {205, 133, 0}},
+  {"orange4", {139, 90, 0}},
+  {"darkorange1", {255, 127, 0}},
+  {"darkorange2", {238, 118, 0}},
+  {"darkorange3", {205, 102, 0}},
+  {"darkorange4", {139, 69, 0}},
+  {"coral1", {255, 114, 86}},
+  {"coral2", {238, 106, 80}},
+  {"coral3", {205, 91, 69}},
+  {"coral4", {139, 62, 47}},
+  {"tomato1", {255, 99, 71}},
+  {"tomato2", {238, 92, 66}},
+  {"tomato3", {205, 79, 57}},
+  {"tomato4", {139, 54, 38}},
+  {"orangered1", {255, 69, 0}},
+  {"orangered2", {238, 64, 0}},
+  {"orangered3", {205, 55, 0}},
+  {"orangered4", {139, 37, 0}},
+  {"red1", {255, 0, 0}},
+  {"red2", {238, 0, 0}},
+  {"red3", {205, 0, 0}},
+  {"red4", {139, 0, 0}},
+  {"deeppink1", {255, 20, 147}},
+  {"deeppink2", {238, 18, 137}},
+  {"deeppink3", {205, 16, 118}},
+  {"deeppink4", {139, 10, 80}},
+  {"hotpink1", {255, 110, 180}},
+  {"hotpink2", {238, 106, 167}},
+  {"hotpink3", {205, 96, 144}},
+  {"hotpink4", {139, 58, 98}},
+  {"pink1", {255, 181, 197}},
+  {"pink2", {238, 169, 184}},
+  {"pink3", {205, 145, 158}},
+  {"pink4", {139, 99, 108}},
+  {"lightpink1", {255, 174, 185}},
+  {"lightpink2", {238, 162, 173}},
+  {"lightpink3", {205, 140, 149}},
+  {"lightpink4", {139, 95, 101}},
+  {"palevioletred1", {255, 130, 171}},
+  {"palevioletred2", {238, 121, 159}},
+  {"palevioletred3", {205, 104, 137}},
+  {"palevioletred4", {139, 71, 93}},
+  {"maroon1", {255, 52, 179}},
+  {"maroon2", {238, 48, 167}},
+  {"maroon3", {205, 41, 144}},
+  {"maroon4", {139, 28, 98}},
+  {"violetred1", {255, 62, 150}},
+  {"violetred2", {238, 58, 140}},
+  {"violetred3", {205, 50, 120}},
+  {"violetred4", {139, 34, 82}},
+  {"magenta1", {255, 0, 255}},
+  {"magenta2", {238, 0, 238}},
+  {"magenta3", {205, 0, 205}},
+  {"magenta4", {139, 0, 139}},
+  {"orchid1", {255, 131, 250}},
+  {"orchid2", {238, 122, 233}},
+  {"orchid3", {205, 105, 201}},
+  {"orchid4", {139, 71, 137}},
+  {"plum1", {255, 187, 255}},
+  {"plum2", {238, 174, 238}},
+  {"plum3", {205, 150, 205}},
+  {"plum4", {139, 102, 139}},
+  {"mediumorchid1", {224, 102, 255}},
+  {"mediumorchid2", {209, 95, 238}},
+  {"mediumorchid3", {180, 82, 205}},
+  {"mediumorchid4", {122, 55, 139}},
+  {"darkorchid1", {191, 62, 255}},
+  {"darkorchid2", {178, 58, 238}},
+  {"darkorchid3", {154, 50, 205}},
+  {"darkorchid4", {104, 34, 139}},
+  {"purple1", {155, 48, 255}},
+  {"purple2", {145, 44, 238}},
+  {"purple3", {125, 38, 205}},
+  {"purple4", {85, 26, 139}},
+  {"mediumpurple1", {171, 130, 255}},
+  {"mediumpurple2", {159, 121, 238}},
+  {"mediumpurple3", {137, 104, 205}},
+  {"mediumpurple4", {93, 71, 139}},
+  {"thistle1", {255, 225, 255}},
+  {"thistle2", {238, 210, 238}},
+  {"thistle3", {205, 181, 205}},
+  {"thistle4", {139, 123, 139}},
+  {"gray0", {0, 0, 0}},
+  {"grey0", {0, 0, 0}},
+  {"gray1", {3, 3, 3}},
+  {"grey1", {3, 3, 3}},
+  {"gray2", {5, 5, 5}},
+  {"grey2", {5, 5, 5}},
+  {"gray3", {8, 8, 8}},
+  {"grey3", {8, 8, 8}},
+  {"gray4", {10, 10, 10}},
+  {"grey4", {10, 10, 10}},
+  {"gray5", {13, 13, 13}},
+  {"grey5", {13, 13, 13}},
+  {"gray6", {15, 15, 15}},
+  {"grey6", {15, 15, 15}},
+  {"gray7", {18, 18, 18}},
+  {"grey7", {18, 18, 18}},
+  {"gray8", {20, 20, 20}},
+  {"grey8", {20, 20, 20}},
+  {"gray9", {23, 23, 23}},
+  {"grey9", {23, 23, 23}},
+  {"gray10", {26, 26, 26}},
+  {"grey10", {26, 26, 26}},
+  {"gray11", {28, 28, 28}},
+  {"grey11", {28, 28, 28}},
+  {"gray12", {31, 31, 31}},
+  {"grey12", {31, 31, 31}},
+  {"gray13", {33, 33, 33}},
+  {"grey13", {33, 33, 33}},
+  {"gray14", {36, 36, 36}},
+  {"grey14", {36, 36, 36}},
+  {"gray15", {38, 38, 38}},
+  {"grey15", {38, 38, 38}},
+  {"gray16", {41, 41, 41}},
+  {"grey16", {41, 41, 41}},
+  {"gray17", {43, 43, 43}},
+  {"grey17", {43, 43, 43}},
+  {"gray18", {46, 46, 46}},
+  {"grey18", {46, 46, 46}},
+  {"gray19", {48, 48, 48}},
+  {"grey19", {48, 48, 48}},
+  {"gray20", {51, 51, 51}},
+  {"grey20", {51, 51, 51}},
+  {"gray21", {54, 54, 54}},
+  {"grey21", {54, 54, 54}},
+  {"gray22", {56, 56, 56}},
+  {"grey22", {56, 56, 56}},
+  {"gray23", {59, 59, 59}},
+  {"grey23", {59, 59, 59}},
+  {"gray24", {61, 61, 61}},
+  {"grey24", {61, 61, 61}},
+  {"gray25", {64, 64, 64}},
+  {"grey25", {64, 64, 64}},
+  {"gray26", {66, 66, 66}},
+  {"grey26", {66, 66, 66}},
+  {"gray27", {69, 69, 69}},
+  {"grey27", {69, 69, 69}},
+  {"gray28", {71, 71, 71}},
+  {"grey28", {71, 71, 71}},
+  {"gray29", {74, 74, 74}},
+  {"grey29", {74, 74, 74}},
+  {"gray30", {77, 77, 77}},
+  {"grey30", {77, 77, 77}},
+  {"gray31", {79, 79, 79}},
+  {"grey31", {79, 79, 79}},
+  {"gray32", {82, 82, 82}},
+  {"grey32", {82, 82, 82}},
+  {"gray33", {84, 84, 84}},
+  {"grey33", {84, 84, 84}},
+  {"gray34", {87, 87, 87}},
+  {"grey34", {87, 87, 87}},
+  {"gray35", {89, 89, 89}},
+  {"grey35", {89, 89, 89}},
+  {"gray36", {92, 92, 92}},
+  {"grey36", {92, 92, 92}},
+  {"gray37", {94, 94, 94}},
+  {"grey37", {94, 94, 94}},
+  {"gray38", {97, 97, 97}},
+  {"grey38", {97, 97, 97}},
+  {"gray39", {99, 99, 99}},
+  {"grey39", {99, 99, 99}},
+  {"gray40", {102, 102, 102}},
+  {"grey40", {102, 102, 102}},
+  {"gray41", {105, 105, 105}},
+  {"grey41", {105, 105, 105}},
+  {"gray42", {107, 107, 107}},
+  {"grey42", {107, 107, 107}},
+  {"gray43", {110, 110, 110}},
+  {"grey43", {110, 110, 110}},
+  {"gray44", {112, 112, 112}},
+  {"grey44", {112, 112, 112}},
+  {"gray45", {115, 115, 115}},
+  {"grey45", {115, 115, 115}},
+  {"gray46", {117, 117, 117}},
+  {"grey46", {117, 117, 117}},
+  {"gray47", {120, 120, 120}},
+  {"grey47", {120, 120, 120}},
+  {"gray48", {122, 122, 122}},
+  {"grey48", {122, 122, 122}},
+  {"gray49", {125, 125, 125}},
+  {"grey49", {125, 125, 125}},
+  {"gray50", {127, 127, 127}},
+  {"grey50", {127, 127, 127}},
+  {"gray51", {130, 130, 130}},
+  {"grey51", {130, 130, 130}},
+  {"gray52", {133, 133, 133}},
+  {"grey52", {133, 133, 133}},
+  {"gray53", {135, 135, 135}},
+  {"grey53", {135, 135, 135}},
+  {"gray54", {138, 138, 138}},
+  {"grey54", {138, 138, 138}},
+  {"gray55", {140, 140, 140}},
+  {"grey55", {140, 140, 140}},
+  {"gray56", {143, 143, 143}},
+  {"grey56", {143, 143, 143}},
+  {"gray57", {145, 145, 145}},
+  {"grey57", {145, 145, 145}},
+  {"gray58", {148, 148, 148}},
+  {"grey58", {148, 148, 148}},
+  {"gray59", {150, 150, 150}},
+  {"grey59", {150, 150, 150}},
+  {"gray60", {153, 153, 153}},
+  {"grey60", {153, 153, 153}},
+  {"gray61", {156, 156, 156}},
+  {"grey61", {156, 156, 156}},
+  {"gray62", {158, 158, 158}},
+  {"grey62", {158, 158, 158}},
+  {"gray63", {161, 161, 161}},
+  {"grey63", {161, 161, 161}},
+  {"gray64", {163, 163, 163}},
+  {"grey64", {163, 163, 163}},
+  {"gray65", {166, 166, 166}},
+  {"grey65", {166, 166, 166}},
+  {"gray66", {168, 168, 168}},
+  {"grey66", {168, 168, 168}},
+  {"gray67", {171, 171, 171}},
+  {"grey67", {171, 171, 171}},
+  {"gray68", {173, 173, 173}},
+  {"grey68", {173, 173, 173}},
+  {"gray69", {176, 176, 176}},
+  {"grey69", {176, 176, 176}},
+  {"gray70", {179, 179, 179}},
+  {"grey70", {179, 179, 179}},
+  {"gray71", {181, 181, 181}},
+  {"grey71", {181, 181, 181}},
+  {"gray72", {184, 184, 184}},
+  {"grey72", {184, 184, 184}},
+  {"gray73", {186, 186, 186}},
+  {"grey73", {186, 186, 186}},
+  {"gray74", {189, 189, 189}},
+  {"grey74", {189, 189, 189}},
+  {"gray75", {191, 191, 191}},
+  {"grey75", {191, 191, 191}},
+  {"gray76", {194, 194, 194}},
+  {"grey76", {194, 194, 194}},
+  {"gray77", {196, 196, 196}},
+  {"grey77", {196, 196, 196}},
+  {"gray78", {199, 199, 199}},
+  {"grey78", {199, 199, 199}},
+  {"gray79", {201, 201, 201}},
+  {"grey79", {201, 201, 201}},
+  {"gray80", {204, 204, 204}},
+  {"grey80", {204, 204, 204}},
+  {"gray81", {207, 207, 207}},
+  {"grey81", {207, 207, 207}},
+  {"gray82", {209, 209, 209}},
+  {"grey82", {209, 209, 209}},
+  {"gray83", {212, 212, 212}},
+  {"grey83", {212, 212, 212}},
+  {"gray84", {214, 214, 214}},
+  {"grey84", {214, 214, 214}},
+  {"gray85", {217, 217, 217}},
+  {"grey85", {217, 217, 217}},
+  {"gray86", {219, 219, 219}},
+  {"grey86", {219, 219, 219}},
+  {"gray87", {222, 222, 222}},
+  {"grey87", {222, 222, 222}},
+  {"gray88", {224, 224, 224}},
+  {"grey88", {224, 224, 224}},
+  {"gray89", {227, 227, 227}},
+  {"grey89", {227, 227, 227}},
+  {"gray90", {229, 229, 229}},
+  {"grey90", {229, 229, 229}},
+  {"gray91", {232, 232, 232}},
+  {"grey91", {232, 232, 232}},
+  {"gray92", {235, 235, 235}},
+  {"grey92", {235, 235, 235}},
+  {"gray93", {237, 237, 237}},
+  {"grey93", {237, 237, 237}},
+  {"gray94", {240, 240, 240}},
+  {"grey94", {240, 240, 240}},
+  {"gray95", {242, 242, 242}},
+  {"grey95", {242, 242, 242}},
+  {"gray96", {245, 245, 245}},
+  {"grey96", {245, 245, 245}},
+  {"gray97", {247, 247, 247}},
+  {"grey97", {247, 247, 247}},
+  {"gray98", {250, 250, 250}},
+  {"grey98", {250, 250, 250}},
+  {"gray99", {252, 252, 252}},
+  {"grey99", {252, 252, 252}},
+  {"gray100", {255, 255, 255}},
+  {"grey100", {255, 255, 255}},
+  {"darkgrey", {169, 169, 169}},
+  {"darkgray", {169, 169, 169}},
+  {"darkblue", {0, 0, 139}},
+  {"darkcyan", {0, 139, 139}},
+  {"darkmagenta", {139, 0, 139}},
+  {"darkred", {139, 0, 0}},
+  {"lightgreen", {144, 238, 144}}
+};
+
+constexpr char x11_to_lower(char ch) {
+  return ch >= 'A' && ch <= 'Z' ? (char)(ch - 'A' + 'a') : ch;
+}
+
+// Compares colour names as X11 does, ignoring case and spaces, so that a
+// multi-word name such as "light blue" matches "LightBlue" where it lies.
+constexpr bool x11_names_equal(std::string_view a, std::string_view b) {
+  std::string_view::size_type i = 0;
+  std::string_view::size_type j = 0;
+
+  while (true) {
+    while (i < a.size() && a[i] == ' ')
+      i++;
+
+    while (j < b.size() && b[j] == ' ')
+      j++;
+
+    if (i == a.size() || j == b.size())
+      return i == a.size() && j == b.size();
+
+    if (x11_to_lower(a[i++]) != x11_to_lower(b[j++]))
+      return false;
+  }
+}
+
+// FNV-1a over the lowercased name without its spaces, so lookups ignore
+// both without a copy.
+constexpr std::uint64_t x11_colour_hash(std::string_view name) {
+  std::uint64_t result = 0xcbf29ce484222325;
+
+  for (const char ch : name)
+    if (ch != ' ')
+      result = (result ^ (unsigned char)x11_to_lower(ch)) * 0x100000001b3;
+
+  return result;
+}
+
+constexpr std::size_t x11_bucket_count = 256;
+constexpr std::size_t x11_slot_count = 1024;
+
+struct X11ColourTable {
+  std::uint16_t displacements[x11_bucket_count];
+  // Index into x11_colours plus one; zero marks an empty slot.
+  std::uint16_t slots[x11_slot_count];
+};
+
+constexpr std::size_t x11_slot(std::uint64_t hash, std::uint64_t displacement)
+{
+  return ((hash >> 20) + displacement * ((hash >> 40) | 1)) &
+    (x11_slot_count - 1);
+}
+
+// A hash-and-displace perfect hash of x11_colours: each name's bucket gives
+// the displacement to its slot. Finding one takes more constant-evaluation
+// steps than compilers allow by default, so x11_table.cpp searches for it
+// offline and rewrites it here; rebuild and run it after changing
+// x11_colours.
+inline constexpr X11ColourTable x11_colour_table = {
+  {
+    2, 2, 0, 2, 2, 1, 0, 0, 1, 1, 2, 1, 6, 0, 0, 0, 4, 1, 2, 3, 7, 1, 7, 2, 3,
+    1, 1, 2, 3, 3, 3, 11, 22, 5, 8, 0, 1, 1, 4, 0, 1, 0, 17, 1, 2, 1, 2, 5, 0,
+    4, 0, 4, 10, 1, 0, 3, 3, 0, 2, 3, 0, 3, 17, 2, 3, 0, 4, 0, 7, 2, 4, 3, 1,
+    1, 2, 0, 1, 4, 9, 0, 7, 9, 7, 1, 7, 0, 4, 3, 2, 7, 10, 4, 3, 8, 0, 11, 4,
+    3, 2, 9, 0, 6, 11, 3, 4, 11, 11, 4, 1, 0, 0, 7, 3, 2, 8, 7, 1, 0, 0, 2, 3,
+    1, 0, 1, 4, 3, 0, 1, 1, 8, 4, 1, 1, 1, 1, 3, 6, 0, 1, 14, 0, 1, 2, 10, 0,
+    19, 5, 2, 7, 12, 8, 3, 3, 4, 2, 0, 0, 3, 2, 4, 7, 4, 0, 11, 2, 1, 8, 5, 5,
+    3, 4, 15, 2, 5, 1, 1, 21, 7, 1, 3, 6, 0, 5, 19, 5, 6, 0, 8, 13, 3, 25, 10,
+    14, 3, 0, 6, 5, 11, 3, 1, 2, 12, 0, 1, 8, 24, 3, 1, 10, 8, 14, 2, 1, 4, 0,
+    2, 0, 12, 12, 3, 1, 7, 4, 1, 1, 8, 8, 0, 11, 1, 2, 14, 9, 0, 8, 0, 8, 13,
+    33, 0, 7, 3, 7, 7, 13, 1, 0, 4, 2, 1, 0, 8, 0, 0, 1, 3
+  },
+  {
+    221, 0, 369, 109, 0, 0, 0, 657, 427, 552, 447, 641, 235, 0, 568, 351, 234,
+    0, 177, 434, 231, 0, 233, 0, 603, 31, 370, 89, 628, 0, 0, 176, 390, 353, 8,
+    286, 0, 343, 0, 345, 595, 583, 654, 346, 64, 147, 660, 0, 656, 0, 0, 0, 45,
+    296, 175, 478, 123, 13, 364, 643, 0, 0, 156, 0, 0, 0, 0, 0, 141, 178, 0, 0,
+    677, 0, 645, 277, 681, 173, 0, 448, 0, 374, 0, 158, 0, 250, 274, 475, 426,
+    627, 86, 0, 491, 0, 336, 0, 268, 672, 42, 0, 423, 40, 340, 139, 0, 0, 594,
+    240, 0, 480, 0, 579, 0, 205, 669, 557, 575, 96, 0, 187, 379, 299, 0, 456,
+    124, 659, 0, 30, 20, 0, 97, 445, 208, 199, 0, 544, 550, 686, 674, 0, 545,
+    503, 337, 694, 525, 0, 63, 502, 255, 0, 608, 0, 258, 0, 616, 518, 620, 0,
+    626, 520, 21, 56, 182, 17, 0, 543, 492, 554, 555, 612, 357, 0, 473, 487,
+    115, 0, 413, 71, 516, 439, 0, 501, 510, 0, 194, 48, 514, 0, 83, 495, 0, 0,
+    618, 0, 213, 610, 619, 195, 329, 0, 0, 348, 302, 614, 624, 6, 0, 350, 263,
+    474, 246, 0, 0, 0, 392, 245, 47, 220, 265, 580, 522, 142, 393, 0, 46, 130,
+    125, 464, 121, 401, 196, 327, 69, 68, 0, 673, 49, 387, 0, 137, 0, 129, 19,
+    429, 476, 0, 443, 256, 455, 298, 451, 38, 0, 0, 189, 430, 72, 267, 43, 0,
+    0, 622, 157, 418, 0, 355, 377, 0, 524, 409, 0, 407, 365, 93, 489, 410, 113,
+    651, 0, 34, 585, 0, 0, 179, 368, 0, 276, 0, 471, 0, 198, 118, 454, 317, 0,
+    294, 191, 211, 391, 301, 0, 0, 0, 291, 23, 0, 262, 293, 531, 366, 259, 459,
+    260, 122, 541, 601, 446, 303, 0, 638, 0, 80, 0, 0, 271, 553, 0, 587, 73,
+    549, 0, 0, 0, 591, 152, 0, 228, 692, 609, 281, 613, 150, 53, 0, 0, 470, 0,
+    381, 438, 436, 215, 0, 450, 526, 0, 0, 341, 50, 0, 0, 242, 140, 0, 0, 356,
+    0, 561, 496, 174, 425, 308, 0, 431, 162, 498, 116, 0, 0, 18, 0, 135, 146,
+    634, 170, 88, 0, 0, 534, 342, 4, 0, 0, 76, 397, 284, 395, 292, 596, 380, 0,
+    201, 0, 382, 0, 442, 361, 78, 359, 0, 683, 91, 508, 499, 0, 197, 592, 444,
+    467, 117, 27, 331, 540, 490, 0, 640, 0, 0, 344, 0, 564, 0, 560, 297, 512,
+    352, 412, 295, 143, 0, 0, 0, 151, 244, 0, 0, 486, 0, 29, 0, 693, 680, 0, 0,
+    421, 582, 0, 0, 588, 509, 0, 576, 105, 511, 227, 556, 602, 104, 0, 523,
+    100, 0, 513, 148, 0, 584, 463, 0, 623, 484, 0, 307, 60, 0, 0, 0, 0, 0, 0,
+    144, 279, 238, 12, 360, 462, 188, 81, 66, 183, 621, 0, 0, 0, 419, 330, 323,
+    497, 469, 0, 314, 0, 312, 67, 402, 0, 389, 363, 204, 668, 477, 167, 433, 0,
+    472, 159, 0, 288, 160, 685, 59, 354, 114, 180, 690, 287, 384, 0, 0, 0, 247,
+    0, 386, 9, 0, 0, 416, 0, 0, 232, 155, 0, 0, 168, 243, 617, 0, 538, 661,
+    145, 0, 528, 440, 532, 504, 671, 0, 0, 458, 218, 79, 675, 332, 0, 465, 269,
+    0, 679, 0, 527, 225, 494, 0, 533, 0, 237, 101, 537, 229, 153, 452, 0, 347,
+    270, 0, 249, 108, 432, 36, 373, 0, 311, 103, 422, 33, 0, 241, 0, 0, 131, 0,
+    481, 239, 278, 2, 0, 453, 0, 0, 548, 0, 383, 186, 606, 0, 316, 615, 0, 417,
+    0, 107, 403, 0, 335, 85, 0, 665, 375, 586, 0, 0, 378, 0, 0, 26, 92, 172,
+    305, 0, 62, 0, 0, 0, 222, 0, 223, 0, 483, 0, 65, 0, 309, 0, 367, 254, 0,
+    253, 75, 251, 670, 0, 184, 0, 106, 275, 687, 236, 161, 87, 0, 285, 99, 289,
+    338, 0, 0, 290, 320, 0, 134, 98, 257, 37, 0, 0, 569, 0, 0, 411, 572, 0, 0,
+    10, 570, 398, 0, 57, 689, 396, 7, 0, 32, 102, 0, 435, 1, 461, 0, 441, 655,
+    566, 678, 44, 0, 562, 630, 682, 0, 558, 437, 563, 11, 206, 0, 0, 0, 551,
+    15, 51, 0, 216, 120, 84, 598, 35, 90, 127, 339, 0, 636, 399, 0, 3, 54, 394,
+    0, 0, 468, 310, 664, 326, 0, 74, 428, 0, 644, 0, 449, 28, 0, 226, 0, 318,
+    590, 77, 0, 0, 0, 0, 171, 0, 597, 0, 283, 315, 126, 607, 128, 385, 420,
+    362, 0, 466, 0, 642, 0, 0, 0, 405, 0, 112, 0, 604, 0, 0, 600, 0, 507, 0, 0,
+    625, 517, 488, 217, 0, 521, 415, 0, 667, 0, 110, 0, 0, 25, 0, 0, 0, 400, 0,
+    0, 230, 200, 406, 0, 328, 164, 24, 0, 0, 14, 0, 94, 0, 0, 82, 212, 154, 0,
+    193, 214, 485, 0, 631, 653, 111, 649, 0, 0, 0, 0, 529, 0, 273, 663, 535,
+    688, 539, 424, 0, 589, 0, 0, 306, 261, 304, 138, 0, 133, 637, 0, 0, 166, 0,
+    210, 515, 333, 648, 457, 163, 207, 0, 70, 0, 334, 0, 0, 658, 324, 0, 190,
+    646, 0, 0, 266, 0, 0, 519, 264, 0, 565, 629, 639, 61, 313, 0, 358, 408,
+    460, 376, 52, 0, 325, 95, 0, 192, 635, 181, 349, 578, 0, 574, 0, 203, 41,
+    282, 132, 0, 0, 280, 248, 684, 0, 605, 404, 676, 55, 0, 0, 0, 0, 0, 169, 0,
+    0, 136, 414, 633, 300, 573, 0, 482, 500, 559, 39, 165, 0, 505, 0, 546, 0,
+    371, 0, 493, 652, 224, 666, 536, 650, 372, 691, 542, 662, 388, 0, 530, 272,
+    632, 506, 252, 547, 0, 571, 5, 567, 22, 581, 185, 577, 0, 58, 0, 16, 479,
+    322, 0, 0, 599, 319, 695, 321, 209, 202, 0, 0, 0, 0, 0, 611, 149, 0, 219,
+    0, 593, 119, 647, 0
+  }
+};
+
+// Looks name up with a single probe, ignoring case and spaces; returns
+// nullptr if it is not an X11 colour name.
+constexpr const X11Colour* find_x11_colour(std::string_view name) {
+  const std::uint64_t hash = x11_colour_hash(name);
+
+  const std::uint16_t entry = x11_colour_table.slots[x11_slot(hash,
+    x11_colour_table.displacements[hash & (x11_bucket_count - 1)])];
+
+  if (!entry || !x11_names_equal(x11_colours[entry - 1].name, name))
+    return nullptr;
+
+  return &x11_colours[entry - 1];
+}
+
+// Whether each colour from first up to last is found in its own slot, which
+// with one entry per slot also means no two colours share one.
+constexpr bool x11_colours_placed(std::size_t first, std::size_t last) {
+  for (auto i = first; i < last && i < std::size(x11_colours); i++) {
+    const std::uint64_t hash = x11_colour_hash(x11_colours[i].name);
+
+    if (x11_colour_table.slots[x11_slot(hash,
+      x11_colour_table.displacements[hash & (x11_bucket_count - 1)])] != i + 1)
+      return false;
+  }
+
+  return true;
+}
+
+// Checks the colours in chunks, each its own constant evaluation, so that no
+// single one needs more steps than compilers allow by default.
+inline constexpr std::size_t x11_check_chunk_size = 32;
+
+template <std::size_t... Chunks>
+constexpr bool x11_colour_table_matches(std::index_sequence<Chunks...>) {
+  return (std::bool_constant<x11_colours_placed(Chunks * x11_check_chunk_size,
+    (Chunks + 1) * x11_check_chunk_size)>::value && ...);
+}
+
+// x11_table.cpp defines XPM_X11_TABLE_UNCHECKED to replace a stale table.
+#ifndef XPM_X11_TABLE_UNCHECKED
+static_assert(x11_colour_table_matches(std::make_index_sequence<
+  (std::size(x11_colours) + x11_check_chunk_size - 1) /
+  x11_check_chunk_size>()),
+  "x11_colour_table is stale; regenerate it with x11_table.cpp");
+#endif
\ No newline at end of file
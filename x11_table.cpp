@@ -0,0 +1,195 @@
+// Regenerates x11_colour_table in x11_colours.h after x11_colours changes.
+// The header cannot check a table it is about to replace.
+#define XPM_X11_TABLE_UNCHECKED 1
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include "x11_colours.h"
+
+// Builds a hash-and-displace perfect hash: names are grouped into buckets by
+// hash, and buckets are placed largest first, each taking the smallest
+// displacement that lands all of its names in free slots.
+static X11ColourTable build_x11_colour_table() {
+  constexpr std::size_t colour_count = std::size(x11_colours);
+  constexpr std::size_t max_bucket_size = 16;
+
+  X11ColourTable table = {};
+  std::uint64_t hashes[colour_count] = {};
+  std::size_t bucket_sizes[x11_bucket_count] = {};
+  std::size_t bucket_starts[x11_bucket_count + 1] = {};
+  std::size_t bucket_members[colour_count] = {};
+  std::size_t largest_bucket_size = 0;
+
+  for (std::size_t i = 0; i < colour_count; i++) {
+    hashes[i] = x11_colour_hash(x11_colours[i].name);
+
+    const std::size_t bucket_size =
+      ++bucket_sizes[hashes[i] & (x11_bucket_count - 1)];
+
+    if (bucket_size > largest_bucket_size)
+      largest_bucket_size = bucket_size;
+  }
+
+  if (largest_bucket_size > max_bucket_size)
+    throw std::runtime_error("an X11 colour hash bucket is too large");
+
+  for (std::size_t bucket = 0; bucket < x11_bucket_count; bucket++)
+    bucket_starts[bucket + 1] = bucket_starts[bucket] + bucket_sizes[bucket];
+
+  std::size_t bucket_fill[x11_bucket_count] = {};
+
+  for (std::size_t i = 0; i < colour_count; i++) {
+    const std::size_t bucket = hashes[i] & (x11_bucket_count - 1);
+
+    bucket_members[bucket_starts[bucket] + bucket_fill[bucket]++] = i;
+  }
+
+  for (auto size = largest_bucket_size; size > 0; size--)
+    for (std::size_t bucket = 0; bucket < x11_bucket_count; bucket++) {
+      if (bucket_sizes[bucket] != size)
+        continue;
+
+      std::size_t slots[max_bucket_size] = {};
+
+      for (std::uint64_t displacement = 0; ; displacement++) {
+        if (displacement > 0xffff)
+          throw std::runtime_error("no displacement fits an X11 colour bucket");
+
+        bool fits = true;
+
+        for (std::size_t j = 0; j < size && fits; j++) {
+          slots[j] = x11_slot(hashes[bucket_members[bucket_starts[bucket] +
+            j]], displacement);
+
+          fits = !table.slots[slots[j]];
+
+          for (std::size_t k = 0; k < j && fits; k++)
+            fits = slots[k] != slots[j];
+        }
+
+        if (fits) {
+          for (std::size_t j = 0; j < size; j++)
+            table.slots[slots[j]] =
+              (std::uint16_t)(bucket_members[bucket_starts[bucket] + j] + 1);
+
+          table.displacements[bucket] = (std::uint16_t)displacement;
+
+          break;
+        }
+      }
+    }
+
+  return table;
+}
+
+// Writes values as the body of a braced list, as many to a line as fit in 80
+// columns.
+template <std::size_t Size>
+static void append_values(std::string& s, const std::uint16_t (&values)[Size])
+{
+  std::string line = "   ";
+
+  s += "  {\n";
+
+  for (std::size_t i = 0; i < Size; i++) {
+    const std::string value = ' ' + std::to_string(values[i]) +
+      (i + 1 < Size ? "," : "");
+
+    if (line.size() + value.size() > 79) {
+      s += line + '\n';
+      line = "   ";
+    }
+
+    line += value;
+  }
+
+  s += line + "\n  }";
+}
+
+// The definition of x11_colour_table as it appears in x11_colours.h.
+static std::string x11_colour_table_definition(const X11ColourTable& table) {
+  std::string result = "inline constexpr X11ColourTable x11_colour_table = {\n";
+
+  append_values(result, table.displacements);
+  result += ",\n";
+  append_values(result, table.slots);
+
+  return result + "\n};";
+}
+
+// Replaces the definition of x11_colour_table in the header at header_path.
+static void update_header(const std::string& header_path,
+  const std::string& definition)
+{
+  std::string header;
+
+  {
+    std::ifstream in(header_path, std::ios::binary);
+
+    if (!in)
+      throw std::runtime_error("could not read " + header_path);
+
+    header.assign(std::istreambuf_iterator<char>(in),
+      std::istreambuf_iterator<char>());
+  }
+
+  const std::string::size_type start = header.find(
+    "inline constexpr X11ColourTable x11_colour_table = {");
+
+  const std::string::size_type end = header.find("\n};", start);
+
+  if (start == std::string::npos || end == std::string::npos)
+    throw std::runtime_error(header_path + " has no x11_colour_table");
+
+  // Keeps the header's line endings; a "\r\n};" end is matched by its
+  // "\n};" and replaced along with its "\r".
+  std::string replacement = definition;
+
+  if (header.find("\r\n") != std::string::npos) {
+    for (std::string::size_type pos = 0;
+      (pos = replacement.find('\n', pos)) != std::string::npos; pos += 2)
+    {
+      replacement.insert(pos, 1, '\r');
+    }
+  }
+
+  header.replace(start, end + 3 - start, replacement);
+
+  std::ofstream out(header_path, std::ios::binary);
+
+  if (!(out << header))
+    throw std::runtime_error("could not write " + header_path);
+}
+
+int main(int argc, char** argv) {
+  if (argc > 2) {
+    std::cerr << "usage: xpm-x11-table [x11_colours.h]\n";
+
+    return 2;
+  }
+
+  try {
+    const std::string definition = x11_colour_table_definition(
+      build_x11_colour_table());
+
+    if (argc == 2)
+      update_header(argv[1], definition);
+
+    else
+      std::cout << definition << '\n';
+  }
+
+  catch (const std::exception& ex) {
+    std::cerr << "xpm-x11-table: " << ex.what() << '\n';
+
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -1,416 +1,632 @@
-#include "xpm.h"
-#include <algorithm>
-#include <charconv>
-#include <system_error>
-#include <cctype>
-#include "x11_colours.h"
-
-Xpm::Xpm() : _width(0), _height(0), _colour_count(0), _chars_per_pixel(0)
-{
-
-}
-
-const int& Xpm::width() const {
-  return _width;
-}
-
-const int& Xpm::height() const {
-  return _height;
-}
-
-const int& Xpm::colour_count() const {
-  return _colour_count;
-}
-
-const int& Xpm::chars_per_pixel() const {
-  return _chars_per_pixel;
-}
-
-const std::map<std::string, Rgba>& Xpm::colour_map() const {
-  return _colour_map;
-}
-
-const std::vector<std::vector<std::string>>& Xpm::pixels() const {
-  return _pixels;
-}
-
-static std::string strip_unicode(std::wstring_view s) {
-  std::string result;
-
-  for (auto ch : s)
-    if (ch >= 0 && ch < 128)
-      result.push_back((char)ch);
-
-  return result;
-}
-
-static std::vector<std::string> split_string(std::string_view s,
-  const char delim)
-{
-  auto last_delim_pos = std::string::npos;
-  std::vector<std::string> result;
-
-  for (std::string_view::size_type i = 0; i < s.size(); i++)
-    if (s[i] == delim) {
-      if (last_delim_pos == std::string::npos) {
-        if (i)
-          result.push_back((std::string)s.substr(0, i));
-      }
-
-      else
-        if (i - last_delim_pos > 1)
-          result.push_back((std::string)s.substr(last_delim_pos + 1,
-            i - last_delim_pos - 1));
-
-      last_delim_pos = i;
-    }
-
-    else if (i == s.size() - 1)
-      result.push_back((std::string)s.substr(last_delim_pos + 1));
-
-  return result;
-}
-
-enum class StripDirection
-{
-  left,
-  right,
-  left_and_right,
-};
-
-static bool is_whitespace(const char ch) {
-  return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
-}
-
-static std::string strip_whitespace(std::string_view s,
-  const StripDirection& direction = StripDirection::left_and_right)
-{
-  auto find_start_pos = [&s]() {
-    auto start_pos = std::string::npos;
-
-    for (std::string_view::size_type i = 0; i < s.size(); i++)
-      if (!is_whitespace(s[i])) {
-        start_pos = i;
-
-        break;
-      }
-
-    return start_pos;
-  };
-
-  auto find_end_pos = [&s](const std::string_view::size_type start_pos = 0) {
-    auto end_pos = s.size() - 1;
-
-    for (std::string_view::size_type i = s.size() - 1; i >= start_pos; i--)
-      if (!is_whitespace(s[i])) {
-        end_pos = i;
-
-        break;
-      }
-
-    return end_pos;
-  };
-
-  if (direction == StripDirection::right)
-    return (std::string)s.substr(0, find_end_pos() + 1);
-
-  const auto start_pos = find_start_pos();
-
-  if (start_pos == std::string::npos)
-    return "";
-
-  if (direction == StripDirection::left)
-    return (std::string)s.substr(start_pos);
-
-  return (std::string)s.substr(start_pos,
-    find_end_pos(start_pos) - start_pos + 1);
-}
-
-std::string Xpm::Xpm2ToXpm3(std::wstring_view file_name,
-  std::string file_contents)
-{
-  std::string array_name = strip_unicode(file_name);
-  const auto dot_pos = file_name.find('.');
-
-  if (dot_pos != std::string::npos)
-    array_name = array_name.substr(0, dot_pos);
-
-  std::replace(array_name.begin(), array_name.end(), ' ', '_');
-
-  std::string result = "/* XPM */\nstatic char* " + array_name +
-    "_xpm[] = {\n";
-
-  std::replace(file_contents.begin(), file_contents.end(), '\r', '\n');
-
-  const std::vector<std::string> lines = split_string(file_contents, '\n');
-
-  if (!lines.empty()) {
-    const std::string line_0_left_stripped = strip_whitespace(lines[0],
-      StripDirection::left);
-
-    bool has_header = false;
-
-    if (!line_0_left_stripped.empty())
-      has_header = line_0_left_stripped[0] == '!';
-
-    for (std::vector<std::string>::size_type i = has_header; i < lines.size();
-      i++)
-    {
-      const std::string& line = lines[i];
-      result += "  \"" + line + '"';
-
-      if (line != lines.back())
-        result += ',';
-
-      result += '\n';
-    }
-  }
-
-  return result + "};";
-}
-
-std::string Xpm::Xpm3ToXpm2(std::string_view file_contents) {
-  const auto start_pos = file_contents.find('{');
-
-  if (start_pos == std::string::npos)
-    return "";
-
-  const auto end_pos = file_contents.find('}');
-
-  if (end_pos == std::string::npos)
-    return "";
-
-  std::string elements_area = (std::string)file_contents.substr(start_pos + 1,
-    end_pos - start_pos - 1);
-
-  bool in_quote = false;
-  std::vector<std::string> raw_elements = { "" };
-
-  for (std::string::size_type i = 0, raw_element_index = 0;
-    i < file_contents.size(); i++)
-  {
-    if (file_contents[i] == '"') {
-      in_quote = !in_quote;
-
-      continue;
-    }
-
-    if (in_quote)
-      raw_elements[raw_element_index].push_back(file_contents[i]);
-
-    else if (file_contents[i] == ',') {
-      raw_elements.push_back("");
-      raw_element_index += 1;
-    }
-  }
-
-  std::string result = "! XPM2";
-
-  for (auto& raw_element : raw_elements) {
-    if (!raw_element.empty()) {
-      if (raw_element.front() == '"')
-        raw_element.erase(0, 1);
-
-      if (!raw_element.empty() && raw_element.back() == '"')
-        raw_element.pop_back();
-
-      result += '\n' + raw_element;
-    }
-  }
-  
-   return result;
-}
-
-static bool string_to_int(std::string_view s, int& result, const int base = 10)
-{
-  auto [ptr, ec] { std::from_chars(s.data(), s.data() + s.size(), result, base)
-    };
-
-  if (ec == std::errc())
-    if (ptr == s.data() + s.size())
-      return true;
-
-  return false;
-}
-
-static void string_to_lower(std::string& s) {
-  std::transform(s.begin(), s.end(), s.begin(),
-    [](unsigned char c) { return std::tolower(c); });
-}
-
-void Xpm::ParseXpm2(std::string file_contents) {
-  std::replace(file_contents.begin(), file_contents.end(), '\r', '\n');
-
-  std::vector<std::string> lines = split_string(file_contents, '\n');
-
-  auto invalid_file_error = [](unsigned int line) {
-    // printf("Runtime error thrown on line: %d\n", line);
-    throw std::runtime_error("the specified XPM file is invalid");
-  };
-
-  if (lines.empty())
-    invalid_file_error(__LINE__);
-
-  const auto sections_start = strip_whitespace(lines[0],
-    StripDirection::left)[0] == '!';
-
-  if (lines.size() < 2)
-    invalid_file_error(__LINE__);
-
-  auto parse_values = [this, &invalid_file_error](std::string& values_line) {
-    std::replace(values_line.begin(), values_line.end(), '\t', ' ');
-
-    const std::vector<std::string> raw_values = split_string(values_line, ' ');
-
-    if (raw_values.size() < 4)
-      invalid_file_error(__LINE__);
-
-    for (auto i = 0; i < 4; i++) {
-      int result;
-
-      if (!string_to_int(raw_values[i], result))
-        invalid_file_error(__LINE__);
-
-      if (result < 1)
-        invalid_file_error(__LINE__);
-
-      switch (i) {
-      case 0:
-        _width = result;
-
-        break;
-
-      case 1:
-        _height = result;
-
-        break;
-
-      case 2:
-        _colour_count = result;
-
-        break;
-
-      case 3:
-        _chars_per_pixel = result;
-
-        break;
-      }
-    }
-  };
-
-  parse_values(lines[sections_start]);
-
-  if (_width % _chars_per_pixel != 0)
-    invalid_file_error(__LINE__);
-
-  if (lines.size() - 1 - sections_start != (unsigned int)_colour_count + _height)
-    invalid_file_error(__LINE__);
-
-  const auto colours_end = sections_start + 1 + _colour_count;
-
-  auto parse_colours = [&sections_start, &colours_end, &lines, this,
-    &invalid_file_error]()
-  {
-    for (auto i = sections_start + 1; i < colours_end; i++) {
-      std::string_view line = lines[i];
-
-      if ((int)line.size() < _chars_per_pixel + 1)
-        invalid_file_error(__LINE__);
-
-      const std::vector<std::string> colour_type_and_value = split_string(
-        line.substr(_chars_per_pixel + 1), ' ');
-
-      if (colour_type_and_value.size() < 2)
-        invalid_file_error(__LINE__);
-
-      std::string_view chars = line.substr(0, _chars_per_pixel);
-
-      if (colour_type_and_value[0].size() != 1)
-        invalid_file_error(__LINE__);
-
-      const char& colour_type = colour_type_and_value[0][0];
-
-      auto unsupported_colour_type_error = [](std::string_view colour_type) {
-        throw std::runtime_error((std::string)colour_type +
-          " colours are not yet supported");
-      };
-
-      if (colour_type == 's')
-        unsupported_colour_type_error("symbolic");
-
-      if (colour_type == 'm')
-        unsupported_colour_type_error("monochrome");
-
-      if (colour_type == 'g')
-        unsupported_colour_type_error("greyscale");
-
-      if (colour_type != 'c')
-        invalid_file_error(__LINE__);
-
-      std::string colour = colour_type_and_value[1];
-      Rgba rgba = {};
-
-      if (colour[0] == '#' && colour.size() == 7) {
-        if (!string_to_int(colour.substr(1, 2), rgba.r, 16))
-          invalid_file_error(__LINE__);
-
-        if (!string_to_int(colour.substr(3, 2), rgba.g, 16))
-          invalid_file_error(__LINE__);
-
-        if (!string_to_int(colour.substr(5, 2), rgba.b, 16))
-          invalid_file_error(__LINE__);
-
-        rgba.a = 255;
-      }
-
-      else {
-        for (std::vector<std::string>::size_type j = 2;
-          j < colour_type_and_value.size(); j++)
-        {
-          colour += colour_type_and_value[j];
-        }
-
-        string_to_lower(colour);
-
-        if (colour != "none")
-          if (x11_colour_map.count(colour)) {
-            Rgb rgb = x11_colour_map.find(colour)->second;
-            rgba = { rgb.r, rgb.g, rgb.b, 255 };
-          }
-
-          else
-            invalid_file_error(__LINE__);
-      }
-
-      _colour_map.insert(std::pair<std::string, Rgba>(chars, rgba));
-    }
-  };
-
-  parse_colours();
-
-  auto parse_pixels = [&colours_end, &lines, this, &invalid_file_error]() {
-    for (std::vector<std::string>::size_type r = colours_end; r < lines.size();
-      r++)
-    {
-      std::string_view row = lines[r];
-
-      if (row.size() / _chars_per_pixel != (unsigned int)_width)
-        invalid_file_error(__LINE__);
-
-      _pixels.push_back({});
-
-      for (std::string_view::size_type c = 0; c < row.size();
-        c += _chars_per_pixel)
-      {
-        _pixels[r - colours_end].push_back((std::string)row.substr(c,
-          _chars_per_pixel));
-      }
-    }
-  };
-
-  parse_pixels();
-}
-
-void Xpm::ParseXpm3(std::string file_contents) {
-  ParseXpm2(Xpm3ToXpm2(file_contents));
+#include "xpm.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include "parallel.h"
+#include "xpm_parse.h"
+
+const char* xpm_error_message(XpmError error) {
+  switch (error) {
+  case XpmError::none:
+    return "no error";
+
+  case XpmError::syntax:
+    return "the XPM3 array is malformed or incomplete";
+
+  case XpmError::missing_values:
+    return "the values line is missing";
+
+  case XpmError::invalid_values:
+    return "the values line is invalid";
+
+  case XpmError::missing_colour:
+    return "the colour table is incomplete";
+
+  case XpmError::invalid_colour:
+    return "a colour line is invalid";
+
+  case XpmError::unsupported_colour_type:
+    return "a colour type is not yet supported";
+
+  case XpmError::unknown_colour_name:
+    return "a colour name is not an X11 colour";
+
+  case XpmError::duplicate_key:
+    return "a key is defined more than once";
+
+  case XpmError::missing_row:
+    return "the pixel rows are incomplete";
+
+  case XpmError::invalid_row_width:
+    return "a pixel row has the wrong width";
+
+  case XpmError::undefined_key:
+    return "a pixel key is not in the colour table";
+
+  case XpmError::trailing_data:
+    return "there is data after the last pixel row";
+  }
+
+  return "unknown error";
+}
+
+std::string XpmParseError::message() const {
+  return (std::string)xpm_error_message(error) + " (line " +
+    std::to_string(line) + ", column " + std::to_string(column) + ')';
+}
+
+Xpm::Xpm() : _width(0), _height(0), _colour_count(0), _chars_per_pixel(0)
+{
+
+}
+
+// Starts an empty image on the resource options name, or on a new arena large
+// enough for the usual image parsed from input_size bytes.
+Xpm::Xpm(const XpmParseOptions& options, std::size_t input_size) :
+  _arena(options.memory_resource ? nullptr :
+    std::make_unique<std::pmr::monotonic_buffer_resource>(
+      input_size + 0x1000)),
+  _width(0), _height(0), _colour_count(0), _chars_per_pixel(0),
+  _keys(_arena ? _arena.get() : options.memory_resource),
+  _palette(_keys.get_allocator()),
+  _indices(std::in_place_index<0>, _keys.get_allocator())
+{
+
+}
+
+// The storage keeps the resource it was built with, so rather than assigning
+// member by member, which would copy into this image's old resource, the
+// image is rebuilt from other.
+Xpm& Xpm::operator=(Xpm&& other) noexcept {
+  if (this != &other) {
+    this->~Xpm();
+    new (this) Xpm(std::move(other));
+  }
+
+  return *this;
+}
+
+std::pmr::memory_resource* Xpm::memory_resource() const {
+  return _keys.get_allocator().resource();
+}
+
+const int& Xpm::width() const {
+  return _width;
+}
+
+const int& Xpm::height() const {
+  return _height;
+}
+
+const int& Xpm::colour_count() const {
+  return _colour_count;
+}
+
+const int& Xpm::chars_per_pixel() const {
+  return _chars_per_pixel;
+}
+
+const std::pmr::vector<Rgba>& Xpm::palette() const {
+  return _palette;
+}
+
+const XpmIndices& Xpm::indices() const {
+  return _indices;
+}
+
+std::string_view Xpm::key(std::uint32_t index) const {
+  return std::string_view(_keys).substr((std::size_t)index * _chars_per_pixel,
+    _chars_per_pixel);
+}
+
+std::uint32_t Xpm::index(int x, int y) const {
+  const auto i = (std::size_t)y * _width + x;
+
+  return std::visit([i](const auto& indices) {
+    return (std::uint32_t)indices[i];
+  }, _indices);
+}
+
+const Rgba& Xpm::pixel(int x, int y) const {
+  return _palette[index(x, y)];
+}
+
+const XpmStats& Xpm::stats() const {
+  return _stats;
+}
+
+static std::string strip_unicode(std::wstring_view s) {
+  std::string result;
+
+  for (auto ch : s)
+    if (ch >= 0 && ch < 128)
+      result.push_back((char)ch);
+
+  return result;
+}
+
+void Xpm::Xpm2ToXpm3(std::wstring_view file_name,
+  std::string_view file_contents, const XpmSink& sink)
+{
+  std::string array_name = strip_unicode(file_name);
+  const auto dot_pos = file_name.find('.');
+
+  if (dot_pos != std::string::npos)
+    array_name = array_name.substr(0, dot_pos);
+
+  std::replace(array_name.begin(), array_name.end(), ' ', '_');
+
+  SinkBuffer out(sink);
+
+  out.write("/* XPM */\nstatic char* ");
+  out.write(array_name);
+  out.write("_xpm[] = {\n");
+
+  Xpm2Lines lines(file_contents);
+  std::string_view line;
+  bool has_line = lines.next(line);
+  bool first_line = true;
+
+  if (has_line && is_xpm2_header(line))
+    has_line = lines.next(line);
+
+  for (; has_line; has_line = lines.next(line)) {
+    out.write(first_line ? "  \"" : ",\n  \"");
+    out.write_escaped(line);
+    out.write("\"");
+
+    first_line = false;
+  }
+
+  out.write(first_line ? "};" : "\n};");
+  out.flush();
+}
+
+void Xpm::Xpm3ToXpm2(std::string_view file_contents, const XpmSink& sink) {
+  Xpm3Lines lines(file_contents, false);
+  std::string_view line;
+  SinkBuffer out(sink);
+
+  out.write("! XPM2");
+
+  while (lines.next(line)) {
+    out.write("\n");
+    out.write(line);
+  }
+
+  if (lines.malformed())
+    invalid_xpm_error(__LINE__);
+
+  out.flush();
+}
+
+std::string Xpm::Xpm2ToXpm3(std::wstring_view file_name,
+  std::string_view file_contents)
+{
+  std::string result;
+
+  result.reserve(file_contents.size() + file_contents.size() / 8 + 64);
+
+  Xpm2ToXpm3(file_name, file_contents, [&result](std::string_view chunk) {
+    result += chunk;
+  });
+
+  return result;
+}
+
+std::string Xpm::Xpm3ToXpm2(std::string_view file_contents) {
+  std::string result;
+
+  result.reserve(file_contents.size());
+
+  Xpm3ToXpm2(file_contents, [&result](std::string_view chunk) {
+    result += chunk;
+  });
+
+  return result;
+}
+
+template <typename Lines>
+XpmParseError Xpm::Parse(std::string_view file_contents, Lines& lines,
+  const XpmParseOptions& options)
+{
+  std::string_view line;
+
+  _stats = {};
+
+  // Null unless statistics are built in, so the recording below folds away.
+  XpmStats* const stats = XPM_STATS ? &_stats : nullptr;
+  std::optional<XpmPhaseTimer> phase_timer(std::in_place, &_stats.header);
+
+  auto fail = [file_contents](XpmError error, std::size_t offset) {
+    return xpm_parse_error(file_contents, error, offset);
+  };
+
+  auto offset_of = [file_contents, &lines](std::string_view s) {
+    return xpm_offset_of(file_contents, s, lines.position());
+  };
+
+  // For when the walker runs out of lines where error expected another.
+  auto missing = [&fail, &lines](XpmError error) {
+    return fail(lines.malformed() ? XpmError::syntax : error,
+      lines.position());
+  };
+
+  if (!lines.next(line))
+    return missing(XpmError::missing_values);
+
+  if (Lines::has_header_line && is_xpm2_header(line)) {
+    if (stats)
+      stats->header.bytes_scanned += line.size();
+
+    if (!lines.next(line))
+      return missing(XpmError::missing_values);
+  }
+
+  if (stats)
+    stats->header.bytes_scanned += line.size();
+
+  XpmValues values;
+
+  if (!parse_xpm_values(line, values))
+    return fail(XpmError::invalid_values, offset_of(line));
+
+  _width = values.width;
+  _height = values.height;
+  _colour_count = values.colour_count;
+  _chars_per_pixel = values.chars_per_pixel;
+
+  if (!xpm_colour_table_fits(values, lines.remaining()))
+    return fail(XpmError::missing_colour, file_contents.size());
+
+  // Reserving up front keeps the arena from holding every outgrown buffer.
+  _keys.reserve((std::size_t)_colour_count * _chars_per_pixel);
+  _palette.reserve(_colour_count);
+
+  KeyTable key_table(_chars_per_pixel, _colour_count, memory_resource());
+  const int thread_count = resolve_thread_count(options.thread_count);
+
+  auto parse_colours = [&lines, &line, &key_table, &fail, &offset_of,
+    &missing, stats, this]()
+  {
+    for (auto i = 0; i < _colour_count; i++) {
+      if (!lines.next(line))
+        return missing(XpmError::missing_colour);
+
+      if (stats) {
+        stats->colours.bytes_scanned += line.size();
+        stats->colour_count++;
+      }
+
+      Rgba rgba;
+      const XpmError error = parse_xpm_colour(line, _chars_per_pixel, rgba,
+        stats);
+
+      if (error != XpmError::none)
+        return fail(error, offset_of(line));
+
+      const std::string_view chars = line.substr(0, _chars_per_pixel);
+
+      key_table.insert(chars, (std::uint32_t)_palette.size());
+      _keys += chars;
+      _palette.push_back(rgba);
+    }
+
+    return XpmParseError{};
+  };
+
+  // Colour lines are found serially, stopping short if the table is, and
+  // parsed in blocks across threads, each block filling its own stretch of
+  // the palette and keys, before the key table is built from the keys in
+  // parallel. As with the pixel rows, blocks past the earliest failure are
+  // skipped and the error of the first bad line in the file is the one
+  // returned.
+  auto parse_colours_in_parallel = [&lines, &line, &key_table, &fail,
+    &offset_of, &missing, thread_count, stats, this]()
+  {
+    std::pmr::vector<std::string_view> colour_lines(memory_resource());
+    std::pmr::vector<std::size_t> colour_offsets(memory_resource());
+
+    XpmParseError table_error = {};
+
+    colour_lines.reserve(_colour_count);
+    colour_offsets.reserve(_colour_count);
+
+    for (auto i = 0; i < _colour_count; i++) {
+      if (!lines.next(line)) {
+        table_error = missing(XpmError::missing_colour);
+
+        break;
+      }
+
+      if (stats) {
+        stats->colours.bytes_scanned += line.size();
+        stats->colour_count++;
+      }
+
+      colour_lines.push_back(line);
+      colour_offsets.push_back(offset_of(line));
+    }
+
+    _keys.resize((std::size_t)_colour_count * _chars_per_pixel);
+    _palette.resize(_colour_count);
+
+    std::atomic<std::size_t> failed_line(colour_lines.size());
+    XpmError error = XpmError::none;
+    std::mutex mutex;
+
+    parallel_for(colour_lines.size(), 0x400, thread_count,
+      [&colour_lines, &failed_line, &error, &mutex, stats, this](
+        std::size_t begin, std::size_t end)
+      {
+        XpmStats block_stats = {};
+
+        for (auto i = begin; i < end && i < failed_line.load(); i++) {
+          const XpmError line_error = parse_xpm_colour(colour_lines[i],
+            _chars_per_pixel, _palette[i], stats ? &block_stats : nullptr);
+
+          if (line_error != XpmError::none) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (i < failed_line.load()) {
+              failed_line = i;
+              error = line_error;
+            }
+
+            break;
+          }
+
+          std::copy_n(colour_lines[i].data(), _chars_per_pixel,
+            _keys.data() + i * _chars_per_pixel);
+        }
+
+        if (stats) {
+          std::lock_guard<std::mutex> lock(mutex);
+
+          stats->x11_lookups.seconds += block_stats.x11_lookups.seconds;
+          stats->x11_lookups.bytes_scanned +=
+            block_stats.x11_lookups.bytes_scanned;
+
+          stats->x11_lookups.allocations +=
+            block_stats.x11_lookups.allocations;
+
+          stats->x11_lookups.allocated_bytes +=
+            block_stats.x11_lookups.allocated_bytes;
+
+          stats->x11_lookup_count += block_stats.x11_lookup_count;
+        }
+      });
+
+    if (error != XpmError::none)
+      return fail(error, colour_offsets[failed_line]);
+
+    if (table_error.error != XpmError::none)
+      return table_error;
+
+    key_table.insert_all(_keys, thread_count);
+
+    return XpmParseError{};
+  };
+
+  phase_timer.emplace(&_stats.colours);
+
+  // Small tables parse faster than threads start.
+  const XpmParseError colour_error = thread_count > 1 &&
+    _colour_count >= 0x4000 ? parse_colours_in_parallel() : parse_colours();
+
+  if (colour_error.error != XpmError::none)
+    return colour_error;
+
+  if (_colour_count <= 0x100)
+    _indices.emplace<std::pmr::vector<std::uint8_t>>(memory_resource());
+
+  else if (_colour_count <= 0x10000)
+    _indices.emplace<std::pmr::vector<std::uint16_t>>(memory_resource());
+
+  else
+    _indices.emplace<std::pmr::vector<std::uint32_t>>(memory_resource());
+
+  // Finds the first key of row that is not in the table, once decoding has
+  // said there is one. position is the walker's just after the row.
+  auto undefined_key = [&key_table, &fail, file_contents, this](
+    std::string_view row, std::size_t position)
+  {
+    std::size_t pos = 0;
+
+    while (key_table.find(row.substr(pos, _chars_per_pixel)) != KeyTable::npos)
+      pos += _chars_per_pixel;
+
+    return fail(XpmError::undefined_key, xpm_offset_of(file_contents,
+      row.substr(pos), position));
+  };
+
+  auto parse_pixels = [&lines, &line, &key_table, &fail, &offset_of, &missing,
+    &undefined_key, thread_count, file_contents, this](auto& indices)
+  {
+    using Index = typename std::decay_t<decltype(indices)>::value_type;
+
+    const auto row_size = (unsigned long long)_width * _chars_per_pixel;
+
+    if (row_size > lines.remaining() / _height)
+      return fail(XpmError::missing_row, file_contents.size());
+
+    indices.resize((std::size_t)_width * _height);
+
+    const auto decode_row = xpm_row_decoder<Index>(_chars_per_pixel);
+
+    if (thread_count == 1) {
+      for (auto r = 0; r < _height; r++) {
+        if (!lines.next(line))
+          return missing(XpmError::missing_row);
+
+        if (line.size() != row_size)
+          return fail(XpmError::invalid_row_width, offset_of(line));
+
+        if (!decode_row(line, key_table,
+          indices.data() + (std::size_t)r * _width, _width))
+        {
+          return undefined_key(line, lines.position());
+        }
+      }
+
+      return XpmParseError{};
+    }
+
+    // Row boundaries are found serially, stopping at the first missing or
+    // misshapen row, and the rows before it are decoded in parallel. Blocks
+    // past the earliest failure found so far are skipped, so whichever row
+    // fails first in the file is the one reported.
+    std::pmr::vector<std::string_view> rows(memory_resource());
+    std::pmr::vector<std::size_t> row_positions(memory_resource());
+    XpmParseError row_error = {};
+
+    rows.reserve(_height);
+    row_positions.reserve(_height);
+
+    while ((int)rows.size() < _height) {
+      if (!lines.next(line)) {
+        row_error = missing(XpmError::missing_row);
+
+        break;
+      }
+
+      if (line.size() != row_size) {
+        row_error = fail(XpmError::invalid_row_width, offset_of(line));
+
+        break;
+      }
+
+      rows.push_back(line);
+      row_positions.push_back(lines.position());
+    }
+
+    std::atomic<std::size_t> failed_row(rows.size());
+
+    parallel_for(rows.size(), 64, thread_count,
+      [&rows, &key_table, &indices, &decode_row, &failed_row, this](
+        std::size_t begin, std::size_t end)
+      {
+        for (auto r = begin; r < end && r < failed_row.load(); r++)
+          if (!decode_row(rows[r], key_table,
+            indices.data() + r * _width, _width))
+          {
+            atomic_min(failed_row, r);
+
+            break;
+          }
+      });
+
+    if (failed_row.load() < rows.size())
+      return undefined_key(rows[failed_row], row_positions[failed_row]);
+
+    return row_error;
+  };
+
+  phase_timer.emplace(&_stats.pixels);
+
+  const XpmParseError pixel_error = std::visit(parse_pixels, _indices);
+
+  phase_timer.reset();
+
+  if (pixel_error.error != XpmError::none)
+    return pixel_error;
+
+  if (stats) {
+    stats->pixel_count = (std::size_t)_width * _height;
+    stats->pixels.bytes_scanned = stats->pixel_count * _chars_per_pixel;
+  }
+
+  if (lines.next(line))
+    return fail(XpmError::trailing_data, offset_of(line));
+
+  if (lines.malformed())
+    return fail(XpmError::syntax, lines.position());
+
+  return XpmParseError{};
+}
+
+XpmParseResult Xpm::TryParseXpm2(std::string_view file_contents,
+  const XpmParseOptions& options)
+{
+  Xpm xpm(options, file_contents.size());
+  Xpm2Lines lines(file_contents);
+  XpmTracedLines<Xpm2Lines> traced_lines(lines, xpm._stats);
+  const XpmParseError error = xpm.Parse(file_contents, traced_lines, options);
+
+  if (error.error != XpmError::none)
+    return error;
+
+  return xpm;
+}
+
+XpmParseResult Xpm::TryParseXpm3(std::string_view file_contents,
+  const XpmParseOptions& options)
+{
+  Xpm xpm(options, file_contents.size());
+  Xpm3Lines lines(file_contents, true, xpm.memory_resource());
+  XpmTracedLines<Xpm3Lines> traced_lines(lines, xpm._stats);
+  const XpmParseError error = xpm.Parse(file_contents, traced_lines, options);
+
+  if (error.error != XpmError::none)
+    return error;
+
+  return xpm;
+}
+
+void Xpm::ParseXpm2(std::string_view file_contents,
+  const XpmParseOptions& options)
+{
+  XpmParseResult result = TryParseXpm2(file_contents, options);
+
+  if (!result)
+    throw std::runtime_error(result.error().message());
+
+  *this = std::move(*result);
+}
+
+void Xpm::ParseXpm3(std::string_view file_contents,
+  const XpmParseOptions& options)
+{
+  XpmParseResult result = TryParseXpm3(file_contents, options);
+
+  if (!result)
+    throw std::runtime_error(result.error().message());
+
+  *this = std::move(*result);
+}
+
+XpmParseResult::XpmParseResult(Xpm&& xpm) : _value(std::move(xpm)) {
+
+}
+
+XpmParseResult::XpmParseResult(const XpmParseError& error) : _value(error) {
+
+}
+
+XpmParseResult::operator bool() const {
+  return _value.index() == 0;
+}
+
+Xpm& XpmParseResult::operator*() {
+  return std::get<Xpm>(_value);
+}
+
+const Xpm& XpmParseResult::operator*() const {
+  return std::get<Xpm>(_value);
+}
+
+Xpm* XpmParseResult::operator->() {
+  return &std::get<Xpm>(_value);
+}
+
+const Xpm* XpmParseResult::operator->() const {
+  return &std::get<Xpm>(_value);
+}
+
+const XpmParseError& XpmParseResult::error() const {
+  return std::get<XpmParseError>(_value);
 }
\ No newline at end of file
@@ -1,31 +1,158 @@
-#pragma once
-
-#include <map>
-#include <string>
-#include "rgb.h"
-#include <vector>
-
-class Xpm {
-  int _width;
-  int _height;
-  int _colour_count;
-  int _chars_per_pixel;
-  std::map<std::string, Rgba> _colour_map;
-  std::vector<std::vector<std::string>> _pixels;
-
-public:
-  static std::string Xpm2ToXpm3(std::wstring_view file_name,
-    std::string file_contents);
-
-  static std::string Xpm3ToXpm2(std::string_view file_contents);
-
-  Xpm();
-  const int& width() const;
-  const int& height() const;
-  const int& colour_count() const;
-  const int& chars_per_pixel() const;
-  const std::map<std::string, Rgba>& colour_map() const;
-  const std::vector<std::vector<std::string>>& pixels() const;
-  void ParseXpm2(std::string file_contents);
-  void ParseXpm3(std::string file_contents);
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include "rgb.h"
+#include <variant>
+#include <vector>
+#include "xpm_stats.h"
+
+// Row-major palette indices, using the narrowest element type that can
+// address every colour in the palette.
+using XpmIndices = std::variant<std::pmr::vector<std::uint8_t>,
+  std::pmr::vector<std::uint16_t>, std::pmr::vector<std::uint32_t>>;
+
+// Why a file was rejected, from the first problem found in it.
+enum class XpmError
+{
+  none,
+  // The XPM3 array is malformed or cut short.
+  syntax,
+  missing_values,
+  invalid_values,
+  missing_colour,
+  invalid_colour,
+  unsupported_colour_type,
+  unknown_colour_name,
+  // Only a warning from validation, as parsing keeps the first definition.
+  duplicate_key,
+  missing_row,
+  invalid_row_width,
+  undefined_key,
+  trailing_data,
+};
+
+const char* xpm_error_message(XpmError error);
+
+// Why and where a file was rejected. offset is the byte offset of the
+// offending line, pixel key or element, or of the end of the data where
+// something is missing; line and column are its 1-based position in the file.
+// XPM3 elements that had to be unescaped are not views of the file, so their
+// problems are placed at the array walker's position instead.
+struct XpmParseError {
+  XpmError error;
+  std::size_t offset;
+  std::size_t line;
+  std::size_t column;
+
+  // The error's message followed by its line and column.
+  std::string message() const;
+};
+
+// Receives converted output in order, one piece at a time.
+using XpmSink = std::function<void(std::string_view chunk)>;
+
+struct XpmParseOptions {
+  // Threads used to parse large colour tables and decode the pixel rows; 0
+  // uses one per hardware thread.
+  int thread_count = 1;
+
+  // Supplies the image's storage and every parse-time temporary, and must
+  // outlive the Xpm. When null, the Xpm owns a monotonic arena sized from the
+  // input, so a parse makes a handful of allocations and freeing the image
+  // releases them together.
+  std::pmr::memory_resource* memory_resource = nullptr;
+};
+
+class XpmParseResult;
+
+// Move-only; an image keeps the memory resource it was parsed with.
+class Xpm {
+  // Declared ahead of the storage it backs so that it is destroyed last.
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> _arena;
+  int _width;
+  int _height;
+  int _colour_count;
+  int _chars_per_pixel;
+  std::pmr::string _keys;
+  std::pmr::vector<Rgba> _palette;
+  XpmIndices _indices;
+  XpmStats _stats;
+
+  Xpm(const XpmParseOptions& options, std::size_t input_size);
+  std::pmr::memory_resource* memory_resource() const;
+
+  template <typename Lines>
+  XpmParseError Parse(std::string_view file_contents, Lines& lines,
+    const XpmParseOptions& options);
+
+public:
+  // The sink overloads convert in a single pass, handing the output over in
+  // pieces as it is produced.
+  static void Xpm2ToXpm3(std::wstring_view file_name,
+    std::string_view file_contents, const XpmSink& sink);
+
+  static void Xpm3ToXpm2(std::string_view file_contents, const XpmSink& sink);
+
+  static std::string Xpm2ToXpm3(std::wstring_view file_name,
+    std::string_view file_contents);
+
+  static std::string Xpm3ToXpm2(std::string_view file_contents);
+
+  Xpm();
+  Xpm(Xpm&& other) noexcept = default;
+  Xpm& operator=(Xpm&& other) noexcept;
+  const int& width() const;
+  const int& height() const;
+  const int& colour_count() const;
+  const int& chars_per_pixel() const;
+  const std::pmr::vector<Rgba>& palette() const;
+  const XpmIndices& indices() const;
+  std::string_view key(std::uint32_t index) const;
+  std::uint32_t index(int x, int y) const;
+  const Rgba& pixel(int x, int y) const;
+
+  // Statistics for the last parse; all zero unless built with XPM_STATS.
+  const XpmStats& stats() const;
+
+  // Parse without throwing on invalid input, returning the image or why and
+  // where the file was rejected. Only running out of memory throws.
+  static XpmParseResult TryParseXpm2(std::string_view file_contents,
+    const XpmParseOptions& options = {});
+
+  static XpmParseResult TryParseXpm3(std::string_view file_contents,
+    const XpmParseOptions& options = {});
+
+  // As above, throwing the error's message instead. A file that fails to
+  // parse leaves the image as it was.
+  void ParseXpm2(std::string_view file_contents,
+    const XpmParseOptions& options = {});
+
+  void ParseXpm3(std::string_view file_contents,
+    const XpmParseOptions& options = {});
+};
+
+// Holds either a parsed image or the error that stopped the parse, in the
+// manner of std::expected.
+class XpmParseResult {
+  std::variant<Xpm, XpmParseError> _value;
+
+public:
+  XpmParseResult(Xpm&& xpm);
+  XpmParseResult(const XpmParseError& error);
+
+  // Whether the parse succeeded.
+  explicit operator bool() const;
+  Xpm& operator*();
+  const Xpm& operator*() const;
+  Xpm* operator->();
+  const Xpm* operator->() const;
+
+  // Only valid when the parse failed.
+  const XpmParseError& error() const;
 };
\ No newline at end of file
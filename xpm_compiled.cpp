@@ -0,0 +1,357 @@
+#include "xpm_compiled.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+#include "xpm_parse.h"
+
+// The format is little-endian throughout:
+//
+//   0   "XPMC"
+//   4   version (u32)
+//   8   width, height, colour count and chars per pixel (u32 each)
+//   24  bits per index (u8), flags (u8), then zeros up to 32
+//   32  the palette as R, G, B, A bytes, then the keys, zero padded to a
+//       multiple of eight bytes
+//
+// Raw pixels follow as rows of indices packed least significant bit first,
+// each row starting on a byte, then eight zero bytes so that any index can be
+// read with a single unaligned 64-bit load. RLE pixels follow as a table of
+// height + 1 row offsets (u64) into the runs that come after it, each run a
+// varint of its length less one and a varint of its index.
+static const char compiled_magic[] = "XPMC";
+static const std::uint32_t compiled_version = 1;
+static const std::size_t header_size = 32;
+static const int rle_flag = 1;
+
+static void put_uint(std::string& out, std::uint64_t value, int size) {
+  for (auto i = 0; i < size; i++)
+    out.push_back((char)(value >> (i * 8)));
+}
+
+static void put_varint(std::string& out, std::uint64_t value) {
+  for (; value >= 0x80; value >>= 7)
+    out.push_back((char)(value | 0x80));
+
+  out.push_back((char)value);
+}
+
+static std::uint64_t get_uint(std::string_view s, std::size_t pos, int size) {
+  std::uint64_t value = 0;
+
+  for (auto i = 0; i < size; i++)
+    value |= (std::uint64_t)(unsigned char)s[pos + i] << (i * 8);
+
+  return value;
+}
+
+static std::size_t padded(std::size_t size) {
+  return (size + 7) & ~(std::size_t)7;
+}
+
+void write_compiled_xpm(const Xpm& xpm, bool rle, const XpmSink& sink) {
+  const auto width = (std::size_t)xpm.width();
+  const auto colour_count = (std::uint64_t)xpm.colour_count();
+  int bits_per_index = 1;
+
+  while (((std::uint64_t)1 << bits_per_index) < colour_count)
+    bits_per_index++;
+
+  std::string header = compiled_magic;
+
+  put_uint(header, compiled_version, 4);
+  put_uint(header, xpm.width(), 4);
+  put_uint(header, xpm.height(), 4);
+  put_uint(header, xpm.colour_count(), 4);
+  put_uint(header, xpm.chars_per_pixel(), 4);
+  put_uint(header, bits_per_index, 1);
+  put_uint(header, rle ? rle_flag : 0, 1);
+  header.resize(header_size);
+
+  for (const auto& rgba : xpm.palette()) {
+    put_uint(header, rgba.r, 1);
+    put_uint(header, rgba.g, 1);
+    put_uint(header, rgba.b, 1);
+    put_uint(header, rgba.a, 1);
+  }
+
+  for (std::uint32_t i = 0; i < colour_count; i++)
+    header += xpm.key(i);
+
+  header.resize(padded(header.size()));
+
+  SinkBuffer out(sink);
+
+  out.write(header);
+
+  std::visit([&](const auto& indices) {
+    std::string bytes;
+
+    if (rle) {
+      std::string offsets;
+
+      put_uint(offsets, 0, 8);
+
+      for (auto r = 0; r < xpm.height(); r++) {
+        const auto* row = indices.data() + (std::size_t)r * width;
+
+        for (std::size_t c = 0; c < width;) {
+          std::size_t run = 1;
+
+          while (c + run < width && row[c + run] == row[c])
+            run++;
+
+          put_varint(bytes, run - 1);
+          put_varint(bytes, row[c]);
+          c += run;
+        }
+
+        put_uint(offsets, bytes.size(), 8);
+      }
+
+      out.write(offsets);
+      out.write(bytes);
+
+      return;
+    }
+
+    bytes.reserve((width * bits_per_index + 7) / 8);
+
+    for (auto r = 0; r < xpm.height(); r++) {
+      const auto* row = indices.data() + (std::size_t)r * width;
+      std::uint64_t bits = 0;
+      int bit_count = 0;
+
+      bytes.clear();
+
+      for (std::size_t c = 0; c < width; c++) {
+        bits |= (std::uint64_t)row[c] << bit_count;
+        bit_count += bits_per_index;
+
+        for (; bit_count >= 8; bit_count -= 8, bits >>= 8)
+          bytes.push_back((char)bits);
+      }
+
+      if (bit_count)
+        bytes.push_back((char)bits);
+
+      out.write(bytes);
+    }
+
+    out.write(std::string_view("\0\0\0\0\0\0\0\0", 8));
+  }, xpm.indices());
+
+  out.flush();
+}
+
+bool is_compiled_xpm(std::string_view contents) {
+  return contents.substr(0, 4) == compiled_magic;
+}
+
+CompiledXpm::CompiledXpm() : _width(0), _height(0), _colour_count(0),
+  _chars_per_pixel(0), _bits_per_index(0), _rle(false)
+{
+
+}
+
+const int& CompiledXpm::width() const {
+  return _width;
+}
+
+const int& CompiledXpm::height() const {
+  return _height;
+}
+
+const int& CompiledXpm::colour_count() const {
+  return _colour_count;
+}
+
+const int& CompiledXpm::chars_per_pixel() const {
+  return _chars_per_pixel;
+}
+
+Rgba CompiledXpm::colour(std::uint32_t index) const {
+  const auto* rgba = (const unsigned char*)_palette.data() +
+    (std::size_t)index * 4;
+
+  return { rgba[0], rgba[1], rgba[2], rgba[3] };
+}
+
+std::string_view CompiledXpm::key(std::uint32_t index) const {
+  return _keys.substr((std::size_t)index * _chars_per_pixel, _chars_per_pixel);
+}
+
+void CompiledXpm::Load(std::string_view contents) {
+  if (contents.size() < header_size || !is_compiled_xpm(contents))
+    invalid_xpm_error(__LINE__);
+
+  if (get_uint(contents, 4, 4) != compiled_version)
+    throw std::runtime_error("unsupported compiled XPM version");
+
+  std::uint64_t values[4];
+
+  for (auto i = 0; i < 4; i++) {
+    values[i] = get_uint(contents, 8 + i * 4, 4);
+
+    if (values[i] < 1 || values[i] > 0x7fffffff)
+      invalid_xpm_error(__LINE__);
+  }
+
+  const auto bits_per_index = (int)get_uint(contents, 24, 1);
+  const auto flags = (int)get_uint(contents, 25, 1);
+
+  if (bits_per_index < 1 || bits_per_index > 32 || (flags & ~rle_flag))
+    invalid_xpm_error(__LINE__);
+
+  // Sizes are checked against what is left at each step, which keeps the
+  // products below from overflowing.
+  std::string_view rest = contents.substr(header_size);
+  const std::uint64_t width = values[0];
+  const std::uint64_t height = values[1];
+  const std::uint64_t colour_count = values[2];
+  const std::uint64_t chars_per_pixel = values[3];
+
+  if (colour_count > rest.size() / 4 ||
+    chars_per_pixel > (rest.size() - colour_count * 4) / colour_count)
+  {
+    invalid_xpm_error(__LINE__);
+  }
+
+  const std::string_view palette = rest.substr(0, colour_count * 4);
+  const std::string_view keys = rest.substr(colour_count * 4,
+    colour_count * chars_per_pixel);
+
+  const auto pixels_pos = padded(header_size + palette.size() + keys.size());
+
+  if (pixels_pos > contents.size())
+    invalid_xpm_error(__LINE__);
+
+  rest = contents.substr(pixels_pos);
+
+  if (flags & rle_flag) {
+    // Row offsets are checked as each row is read.
+    if (height + 1 > rest.size() / 8)
+      invalid_xpm_error(__LINE__);
+  }
+
+  else {
+    const std::uint64_t row_size = (width * bits_per_index + 7) / 8;
+
+    if (rest.size() < 8 || row_size > (rest.size() - 8) / height)
+      invalid_xpm_error(__LINE__);
+  }
+
+  _width = (int)width;
+  _height = (int)height;
+  _colour_count = (int)colour_count;
+  _chars_per_pixel = (int)chars_per_pixel;
+  _bits_per_index = bits_per_index;
+  _rle = flags & rle_flag;
+  _palette = palette;
+  _keys = keys;
+  _pixels = rest;
+}
+
+void CompiledXpm::ReadRow(int row, std::uint32_t* out) const {
+  if (row < 0 || row >= _height)
+    throw std::out_of_range("row is outside the image");
+
+  const auto width = (std::size_t)_width;
+  const auto colour_count = (std::uint32_t)_colour_count;
+
+  if (_rle) {
+    const std::string_view runs = _pixels.substr(((std::size_t)_height + 1) *
+      8);
+
+    const std::uint64_t start_pos = get_uint(_pixels, (std::size_t)row * 8, 8);
+    const std::uint64_t end_pos = get_uint(_pixels, (std::size_t)row * 8 + 8,
+      8);
+
+    if (start_pos > end_pos || end_pos > runs.size())
+      invalid_xpm_error(__LINE__);
+
+    std::string_view s = runs.substr(start_pos, end_pos - start_pos);
+
+    auto varint = [&s]() {
+      std::uint64_t value = 0;
+
+      for (auto shift = 0; shift < 64; shift += 7) {
+        if (s.empty())
+          break;
+
+        const auto byte = (unsigned char)s[0];
+
+        s.remove_prefix(1);
+        value |= (std::uint64_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+          return value;
+      }
+
+      invalid_xpm_error(__LINE__);
+
+      return value;
+    };
+
+    for (std::size_t c = 0; c < width;) {
+      const std::uint64_t run = varint();
+      const std::uint64_t index = varint();
+
+      if (run >= width - c || index >= colour_count)
+        invalid_xpm_error(__LINE__);
+
+      std::fill(out + c, out + c + run + 1, (std::uint32_t)index);
+      c += run + 1;
+    }
+
+    if (!s.empty())
+      invalid_xpm_error(__LINE__);
+
+    return;
+  }
+
+  // Each index is read with one unaligned load, shifted and masked; the
+  // padding after the last row keeps the load within the file. This assumes
+  // a little-endian host, as are all the viewer's targets.
+  const std::size_t row_size = (width * _bits_per_index + 7) / 8;
+  const auto* bytes = (const unsigned char*)_pixels.data() +
+    (std::size_t)row * row_size;
+
+  const std::uint64_t mask = ((std::uint64_t)1 << _bits_per_index) - 1;
+  std::uint32_t max_index = 0;
+
+  // Byte-sized indices, the common case, are copied without shifting.
+  if (_bits_per_index == 8) {
+    for (std::size_t c = 0; c < width; c++) {
+      out[c] = bytes[c];
+      max_index = std::max(max_index, out[c]);
+    }
+  }
+
+  else {
+    for (std::size_t c = 0, bit = 0; c < width; c++,
+      bit += _bits_per_index)
+    {
+      std::uint64_t word;
+
+      std::memcpy(&word, bytes + bit / 8, 8);
+      out[c] = (std::uint32_t)((word >> (bit % 8)) & mask);
+      max_index = std::max(max_index, out[c]);
+    }
+  }
+
+  // Checking the largest index once keeps a branch out of the loops.
+  if (max_index >= colour_count)
+    invalid_xpm_error(__LINE__);
+}
+
+XpmWriterImage CompiledXpm::writer_image() const {
+  return {
+    _width, _height, _colour_count, _chars_per_pixel,
+    [this](std::uint32_t index) { return key(index); },
+    [this](std::uint32_t index) { return colour(index); },
+    [this](int row, std::uint32_t* indices) { ReadRow(row, indices); }
+  };
+}
\ No newline at end of file
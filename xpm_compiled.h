@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "rgb.h"
+#include "xpm.h"
+#include "xpm_writer.h"
+
+// Writes xpm as a compiled XPM: a fixed header, the RGBA palette and keys,
+// then the palette indices packed at the fewest bits that address every
+// colour. With rle, each row is instead stored as runs of equal indices,
+// which suits icons and other flat artwork.
+void write_compiled_xpm(const Xpm& xpm, bool rle, const XpmSink& sink);
+
+bool is_compiled_xpm(std::string_view contents);
+
+// A view over a compiled XPM, typically a mapped file, which must outlive it.
+// Loading checks the header and section sizes but decodes nothing; pixels
+// are unpacked a row at a time as they are read.
+class CompiledXpm {
+  int _width;
+  int _height;
+  int _colour_count;
+  int _chars_per_pixel;
+  int _bits_per_index;
+  bool _rle;
+  std::string_view _palette;
+  std::string_view _keys;
+  std::string_view _pixels;
+
+public:
+  CompiledXpm();
+  const int& width() const;
+  const int& height() const;
+  const int& colour_count() const;
+  const int& chars_per_pixel() const;
+  Rgba colour(std::uint32_t index) const;
+  std::string_view key(std::uint32_t index) const;
+  void Load(std::string_view contents);
+
+  // Writes the palette indices of row to out, which holds width() elements.
+  void ReadRow(int row, std::uint32_t* out) const;
+
+  // The image as write_xpm takes it, for converting back to XPM2 or XPM3
+  // with the original keys.
+  XpmWriterImage writer_image() const;
+};
\ No newline at end of file
@@ -0,0 +1,562 @@
+#include "xpm_lazy.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+XpmLazyDecoder::XpmLazyDecoder(int tile_size, std::size_t max_tiles) :
+  _tile_size(std::max(tile_size, 1)), _max_tiles(std::max<std::size_t>(
+  max_tiles, 1)), _width(0), _height(0), _colour_count(0),
+  _chars_per_pixel(0), _scan_pos(0)
+{
+
+}
+
+const int& XpmLazyDecoder::width() const {
+  return _width;
+}
+
+const int& XpmLazyDecoder::height() const {
+  return _height;
+}
+
+const int& XpmLazyDecoder::colour_count() const {
+  return _colour_count;
+}
+
+const int& XpmLazyDecoder::chars_per_pixel() const {
+  return _chars_per_pixel;
+}
+
+const std::vector<Rgba>& XpmLazyDecoder::palette() const {
+  return _palette;
+}
+
+std::string_view XpmLazyDecoder::key(std::uint32_t index) const {
+  return std::string_view(_keys).substr((std::size_t)index * _chars_per_pixel,
+    _chars_per_pixel);
+}
+
+template <typename Lines>
+void XpmLazyDecoder::Parse(Lines& lines) {
+  std::string_view line;
+
+  if (!lines.next(line))
+    invalid_xpm_error(__LINE__);
+
+  if (Lines::has_header_line && is_xpm2_header(line) && !lines.next(line))
+    invalid_xpm_error(__LINE__);
+
+  const XpmValues values = parse_xpm_values(line);
+
+  _width = values.width;
+  _height = values.height;
+  _colour_count = values.colour_count;
+  _chars_per_pixel = values.chars_per_pixel;
+
+  if (!xpm_colour_table_fits(values, lines.remaining()))
+    invalid_xpm_error(__LINE__);
+
+  _keys.reserve((std::size_t)_colour_count * _chars_per_pixel);
+  _palette.reserve(_colour_count);
+  _key_table.emplace(_chars_per_pixel, _colour_count);
+
+  for (auto i = 0; i < _colour_count; i++) {
+    if (!lines.next(line))
+      invalid_xpm_error(__LINE__);
+
+    const Rgba rgba = parse_xpm_colour(line, _chars_per_pixel);
+    const std::string_view chars = line.substr(0, _chars_per_pixel);
+
+    _key_table->insert(chars, (std::uint32_t)_palette.size());
+    _keys += chars;
+    _palette.push_back(rgba);
+  }
+
+  const auto row_size = (unsigned long long)_width * _chars_per_pixel;
+
+  if (row_size > lines.remaining() / _height)
+    invalid_xpm_error(__LINE__);
+
+  _row_offsets.reserve(_height);
+  _scan_pos = lines.position();
+}
+
+void XpmLazyDecoder::Open(std::string_view file_contents, bool xpm3) {
+  _file_contents = file_contents;
+
+  // Rows are used as soon as they are read, so one unescape buffer will do.
+  if (xpm3)
+    _xpm3_lines.emplace(file_contents, false);
+
+  else
+    _xpm2_lines.emplace(file_contents);
+}
+
+void XpmLazyDecoder::ParseXpm2(std::string_view file_contents) {
+  XpmLazyDecoder decoder(_tile_size, _max_tiles);
+
+  decoder.Open(file_contents, false);
+  decoder.Parse(*decoder._xpm2_lines);
+  *this = std::move(decoder);
+}
+
+void XpmLazyDecoder::ParseXpm3(std::string_view file_contents) {
+  XpmLazyDecoder decoder(_tile_size, _max_tiles);
+
+  decoder.Open(file_contents, true);
+  decoder.Parse(*decoder._xpm3_lines);
+  *this = std::move(decoder);
+}
+
+bool XpmLazyDecoder::ReadLine(std::size_t& pos, std::string_view& line) {
+  auto read = [&pos, &line](auto& lines) {
+    lines.seek(pos);
+
+    const bool has_line = lines.next(line);
+
+    if (lines.malformed())
+      invalid_xpm_error(__LINE__);
+
+    pos = lines.position();
+
+    return has_line;
+  };
+
+  if (_xpm3_lines)
+    return read(*_xpm3_lines);
+
+  if (_xpm2_lines)
+    return read(*_xpm2_lines);
+
+  return false;
+}
+
+std::string_view XpmLazyDecoder::Row(int row) {
+  const auto row_size = (std::size_t)_width * _chars_per_pixel;
+  std::string_view line;
+
+  // Rows not yet indexed are found by scanning on from the last one found,
+  // which is checked as it goes; reaching the last row also checks that
+  // nothing follows it.
+  while ((int)_row_offsets.size() <= row) {
+    const std::size_t start_pos = _scan_pos;
+
+    if (!ReadLine(_scan_pos, line))
+      invalid_xpm_error(__LINE__);
+
+    if (line.size() != row_size)
+      invalid_xpm_error(__LINE__);
+
+    const char* const begin = _file_contents.data();
+    const bool in_buffer = std::greater_equal<const char*>()(line.data(),
+      begin) && std::less<const char*>()(line.data(),
+      begin + _file_contents.size());
+
+    _row_offsets.push_back(in_buffer ? (std::size_t)(line.data() - begin) :
+      start_pos | escaped_row);
+
+    if ((int)_row_offsets.size() == _height) {
+      std::size_t end_pos = _scan_pos;
+      std::string_view trailing_line;
+
+      if (ReadLine(end_pos, trailing_line))
+        invalid_xpm_error(__LINE__);
+    }
+  }
+
+  std::size_t pos = _row_offsets[row];
+
+  if (!(pos & escaped_row))
+    return _file_contents.substr(pos, row_size);
+
+  // Escaped rows are unescaped again on every read, and one restored from a
+  // sidecar has not been read before, so it is checked as a scanned row is.
+  pos &= ~escaped_row;
+
+  if (!ReadLine(pos, line) || line.size() != row_size)
+    invalid_xpm_error(__LINE__);
+
+  return line;
+}
+
+const XpmLazyDecoder::Tile& XpmLazyDecoder::TileAt(int tile_row,
+  int tile_column)
+{
+  const std::uint64_t id = (std::uint64_t)tile_row << 32 | tile_column;
+  const auto found = _tile_lookup.find(id);
+
+  if (found != _tile_lookup.end()) {
+    _tiles.splice(_tiles.begin(), _tiles, found->second);
+
+    return _tiles.front();
+  }
+
+  const int x = tile_column * _tile_size;
+  const int y = tile_row * _tile_size;
+  const int width = std::min(_tile_size, _width - x);
+  const int height = std::min(_tile_size, _height - y);
+
+  Tile tile = {id, {}};
+
+  if (_colour_count <= 0x100)
+    tile.indices.emplace<std::pmr::vector<std::uint8_t>>();
+
+  else if (_colour_count <= 0x10000)
+    tile.indices.emplace<std::pmr::vector<std::uint16_t>>();
+
+  else
+    tile.indices.emplace<std::pmr::vector<std::uint32_t>>();
+
+  std::visit([x, y, width, height, this](auto& indices) {
+    using Index = typename std::decay_t<decltype(indices)>::value_type;
+
+    const auto decode_row = xpm_row_decoder<Index>(_chars_per_pixel);
+
+    indices.resize((std::size_t)width * height);
+
+    for (auto r = 0; r < height; r++) {
+      const std::string_view row = Row(y + r).substr(
+        (std::size_t)x * _chars_per_pixel,
+        (std::size_t)width * _chars_per_pixel);
+
+      if (!decode_row(row, *_key_table,
+        indices.data() + (std::size_t)r * width, width))
+      {
+        invalid_xpm_error(__LINE__);
+      }
+    }
+  }, tile.indices);
+
+  if (_tiles.size() >= _max_tiles) {
+    _tile_lookup.erase(_tiles.back().id);
+    _tiles.pop_back();
+  }
+
+  _tiles.push_front(std::move(tile));
+  _tile_lookup[id] = _tiles.begin();
+
+  return _tiles.front();
+}
+
+void XpmLazyDecoder::ReadRegion(int x, int y, int width, int height,
+  std::uint32_t* out, std::ptrdiff_t stride)
+{
+  if (x < 0 || y < 0 || width < 0 || height < 0 || x > _width - width ||
+    y > _height - height)
+  {
+    throw std::out_of_range("the region is outside the image");
+  }
+
+  for (auto tile_row = y / _tile_size; height &&
+    tile_row <= (y + height - 1) / _tile_size; tile_row++)
+  {
+    for (auto tile_column = x / _tile_size; width &&
+      tile_column <= (x + width - 1) / _tile_size; tile_column++)
+    {
+      const Tile& tile = TileAt(tile_row, tile_column);
+      const int tile_x = tile_column * _tile_size;
+      const int tile_y = tile_row * _tile_size;
+      const int tile_width = std::min(_tile_size, _width - tile_x);
+
+      // The overlap of the tile and the region, in image coordinates.
+      const int left = std::max(x, tile_x);
+      const int top = std::max(y, tile_y);
+      const int right = std::min(x + width, tile_x + tile_width);
+      const int bottom = std::min(y + height, tile_y + _tile_size);
+
+      std::visit([&](const auto& indices) {
+        for (auto r = top; r < bottom; r++) {
+          const auto* tile_row_indices = indices.data() +
+            (std::size_t)(r - tile_y) * tile_width;
+
+          std::uint32_t* out_row = out + (r - y) * stride;
+
+          for (auto c = left; c < right; c++)
+            out_row[c - x] = tile_row_indices[c - tile_x];
+        }
+      }, tile.indices);
+    }
+  }
+}
+
+void XpmLazyDecoder::IndexAllRows() {
+  if (_height)
+    Row(_height - 1);
+}
+
+// Hashes eight bytes at a time, so checking a sidecar against its file costs
+// far less than parsing the file.
+static std::uint64_t content_hash(std::string_view s) {
+  std::uint64_t result = 0xcbf29ce484222325 ^ s.size();
+  std::size_t i = 0;
+
+  auto mix = [&result](std::uint64_t word) {
+    result = (result ^ word) * 0x9e3779b97f4a7c15;
+    result ^= result >> 29;
+  };
+
+  for (; i + 8 <= s.size(); i += 8) {
+    std::uint64_t word;
+
+    std::memcpy(&word, s.data() + i, 8);
+    mix(word);
+  }
+
+  std::uint64_t tail = 0;
+
+  for (auto shift = 0; i < s.size(); i++, shift += 8)
+    tail |= (std::uint64_t)(unsigned char)s[i] << shift;
+
+  mix(tail);
+
+  return result;
+}
+
+// The sidecar is little-endian throughout. Row offsets are stored as varint
+// deltas from the previous row, with the escaped_row flag in the low bit, so
+// a row takes two or three bytes.
+static const char index_magic[] = "XPMI";
+static const std::uint32_t index_version = 1;
+
+static void put_uint(std::string& out, std::uint64_t value, int size) {
+  for (auto i = 0; i < size; i++)
+    out.push_back((char)(value >> (i * 8)));
+}
+
+static void put_varint(std::string& out, std::uint64_t value) {
+  for (; value >= 0x80; value >>= 7)
+    out.push_back((char)(value | 0x80));
+
+  out.push_back((char)value);
+}
+
+class IndexReader {
+  std::string_view _s;
+
+public:
+  explicit IndexReader(std::string_view s) : _s(s) {}
+
+  bool uint(std::uint64_t& value, int size) {
+    if (_s.size() < (std::size_t)size)
+      return false;
+
+    value = 0;
+
+    for (auto i = 0; i < size; i++)
+      value |= (std::uint64_t)(unsigned char)_s[i] << (i * 8);
+
+    _s.remove_prefix(size);
+
+    return true;
+  }
+
+  bool varint(std::uint64_t& value) {
+    value = 0;
+
+    for (auto shift = 0; shift < 64; shift += 7) {
+      if (_s.empty())
+        return false;
+
+      const auto byte = (unsigned char)_s[0];
+
+      _s.remove_prefix(1);
+      value |= (std::uint64_t)(byte & 0x7f) << shift;
+
+      if (!(byte & 0x80))
+        return true;
+    }
+
+    return false;
+  }
+
+  bool bytes(std::string_view& value, std::size_t size) {
+    if (_s.size() < size)
+      return false;
+
+    value = _s.substr(0, size);
+    _s.remove_prefix(size);
+
+    return true;
+  }
+
+  bool done() const {
+    return _s.empty();
+  }
+};
+
+std::string XpmLazyDecoder::SaveIndex(std::int64_t modified_time) const {
+  std::string result = index_magic;
+
+  put_uint(result, index_version, 4);
+  put_uint(result, _file_contents.size(), 8);
+  put_uint(result, (std::uint64_t)modified_time, 8);
+  put_uint(result, content_hash(_file_contents), 8);
+  put_uint(result, _xpm3_lines ? 3 : 2, 1);
+  put_uint(result, _width, 4);
+  put_uint(result, _height, 4);
+  put_uint(result, _colour_count, 4);
+  put_uint(result, _chars_per_pixel, 4);
+  result += _keys;
+
+  for (const auto& rgba : _palette) {
+    put_uint(result, rgba.r, 1);
+    put_uint(result, rgba.g, 1);
+    put_uint(result, rgba.b, 1);
+    put_uint(result, rgba.a, 1);
+  }
+
+  put_uint(result, _scan_pos, 8);
+  put_uint(result, _row_offsets.size(), 8);
+
+  std::size_t last_pos = 0;
+
+  for (const auto offset : _row_offsets) {
+    const std::size_t pos = offset & ~escaped_row;
+
+    put_varint(result, (pos - last_pos) << 1 | (offset & escaped_row ? 1 : 0));
+    last_pos = pos;
+  }
+
+  return result;
+}
+
+bool XpmLazyDecoder::LoadIndex(std::string_view file_contents,
+  std::string_view index, std::int64_t modified_time)
+{
+  IndexReader reader(index);
+  std::string_view magic;
+  std::uint64_t version, file_size, index_modified_time, hash, format;
+
+  if (!reader.bytes(magic, 4) || magic != index_magic ||
+    !reader.uint(version, 4) || version != index_version ||
+    !reader.uint(file_size, 8) || file_size != file_contents.size() ||
+    !reader.uint(index_modified_time, 8) ||
+    index_modified_time != (std::uint64_t)modified_time ||
+    !reader.uint(hash, 8) || !reader.uint(format, 1) ||
+    (format != 2 && format != 3))
+  {
+    return false;
+  }
+
+  std::uint64_t values[4];
+
+  for (auto& value : values)
+    if (!reader.uint(value, 4) || value < 1 || value > 0x7fffffff)
+      return false;
+
+  // Each colour and row takes at least a byte of the file, which bounds the
+  // sizes read below before anything is allocated for them.
+  if (values[2] > file_size || values[3] > 0xffff || values[1] > file_size)
+    return false;
+
+  XpmLazyDecoder decoder(_tile_size, _max_tiles);
+
+  decoder._width = (int)values[0];
+  decoder._height = (int)values[1];
+  decoder._colour_count = (int)values[2];
+  decoder._chars_per_pixel = (int)values[3];
+
+  std::string_view keys, palette;
+  const auto colour_count = (std::size_t)decoder._colour_count;
+
+  if (!reader.bytes(keys, colour_count * decoder._chars_per_pixel) ||
+    !reader.bytes(palette, colour_count * 4))
+  {
+    return false;
+  }
+
+  decoder._keys = keys;
+  decoder._palette.reserve(colour_count);
+  decoder._key_table.emplace(decoder._chars_per_pixel, decoder._colour_count);
+
+  for (std::size_t i = 0; i < colour_count; i++) {
+    decoder._key_table->insert(decoder.key((std::uint32_t)i),
+      (std::uint32_t)i);
+
+    decoder._palette.push_back({(unsigned char)palette[i * 4],
+      (unsigned char)palette[i * 4 + 1], (unsigned char)palette[i * 4 + 2],
+      (unsigned char)palette[i * 4 + 3]});
+  }
+
+  std::uint64_t scan_pos, row_count;
+
+  if (!reader.uint(scan_pos, 8) || scan_pos > file_size ||
+    !reader.uint(row_count, 8) || row_count > values[1])
+  {
+    return false;
+  }
+
+  const auto row_size = (std::size_t)decoder._width *
+    decoder._chars_per_pixel;
+
+  decoder._scan_pos = scan_pos;
+  decoder._row_offsets.reserve(decoder._height);
+
+  for (std::uint64_t r = 0, pos = 0; r < row_count; r++) {
+    std::uint64_t delta;
+
+    if (!reader.varint(delta))
+      return false;
+
+    pos += delta >> 1;
+
+    // Rows in the buffer must lie wholly within it; escaped rows are
+    // checked when they are read.
+    if (pos > scan_pos || (!(delta & 1) && row_size > file_size - pos))
+      return false;
+
+    decoder._row_offsets.push_back(delta & 1 ? pos | escaped_row : pos);
+  }
+
+  // The hash is checked last, as it reads the whole file.
+  if (!reader.done() || hash != content_hash(file_contents))
+    return false;
+
+  decoder.Open(file_contents, format == 3);
+  *this = std::move(decoder);
+
+  return true;
+}
+
+bool XpmLazyDecoder::OpenIndexed(const std::filesystem::path& file_path,
+  std::string_view file_contents, bool xpm3)
+{
+  const std::filesystem::path index_path = xpm_index_path(file_path);
+  const std::int64_t modified_time = xpm_index_time(file_path);
+
+  // Closed again before the sidecar may be rewritten below.
+  if (std::ifstream index_file{index_path, std::ios::binary}) {
+    const std::string index((std::istreambuf_iterator<char>(index_file)),
+      std::istreambuf_iterator<char>());
+
+    if (LoadIndex(file_contents, index, modified_time))
+      return true;
+  }
+
+  if (xpm3)
+    ParseXpm3(file_contents);
+
+  else
+    ParseXpm2(file_contents);
+
+  IndexAllRows();
+  std::ofstream(index_path, std::ios::binary) << SaveIndex(modified_time);
+
+  return false;
+}
+
+std::filesystem::path xpm_index_path(const std::filesystem::path& file_path) {
+  std::filesystem::path result = file_path;
+
+  result += ".xpmi";
+
+  return result;
+}
+
+std::int64_t xpm_index_time(const std::filesystem::path& file_path) {
+  return std::filesystem::last_write_time(file_path).time_since_epoch().count();
+}
\ No newline at end of file
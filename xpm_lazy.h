@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include "key_table.h"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "rgb.h"
+#include <vector>
+#include "xpm.h"
+#include "xpm_parse.h"
+
+// Decodes an XPM on demand. Parsing reads only the values and colour table;
+// pixel rows are located when first needed, their offsets kept as an index,
+// and decoded a square tile at a time as regions are read, with the most
+// recently used tiles cached. Opening a file costs little more than its
+// colour table, and decoding and memory follow the regions actually read.
+// The file contents must outlive the decoder.
+class XpmLazyDecoder {
+  static constexpr std::size_t escaped_row = ~((std::size_t)-1 >> 1);
+
+  struct Tile {
+    std::uint64_t id;
+    XpmIndices indices;
+  };
+
+  int _tile_size;
+  std::size_t _max_tiles;
+  int _width;
+  int _height;
+  int _colour_count;
+  int _chars_per_pixel;
+  std::string _keys;
+  std::vector<Rgba> _palette;
+  std::optional<KeyTable> _key_table;
+  std::string_view _file_contents;
+  std::optional<Xpm2Lines> _xpm2_lines;
+  std::optional<Xpm3Lines> _xpm3_lines;
+  // The buffer offset of each row found so far, or for an XPM3 row that has
+  // to be unescaped, the walker position to read it from with escaped_row
+  // set. Rows beyond are found by scanning on from _scan_pos, the end of the
+  // last one.
+  std::vector<std::size_t> _row_offsets;
+  std::size_t _scan_pos;
+  // Most recently used first.
+  std::list<Tile> _tiles;
+  std::unordered_map<std::uint64_t, std::list<Tile>::iterator> _tile_lookup;
+
+  template <typename Lines>
+  void Parse(Lines& lines);
+
+  void Open(std::string_view file_contents, bool xpm3);
+
+  bool ReadLine(std::size_t& pos, std::string_view& line);
+  std::string_view Row(int row);
+  const Tile& TileAt(int tile_row, int tile_column);
+
+public:
+  // Tiles are tile_size pixels square, and at most max_tiles are cached.
+  explicit XpmLazyDecoder(int tile_size = 256, std::size_t max_tiles = 64);
+  const int& width() const;
+  const int& height() const;
+  const int& colour_count() const;
+  const int& chars_per_pixel() const;
+  const std::vector<Rgba>& palette() const;
+  std::string_view key(std::uint32_t index) const;
+  void ParseXpm2(std::string_view file_contents);
+  void ParseXpm3(std::string_view file_contents);
+
+  // Finds every remaining row, checking the file's layout to the end.
+  void IndexAllRows();
+
+  // Serializes the values, colour table and the rows indexed so far into a
+  // sidecar keyed by the file's size, a hash of its contents and the
+  // caller's modified_time, typically the file's last write time.
+  std::string SaveIndex(std::int64_t modified_time) const;
+
+  // Restores the decoder from a SaveIndex sidecar for file_contents without
+  // parsing the colour table or scanning indexed rows again. Returns false,
+  // leaving the decoder unchanged, if the sidecar is damaged or was made for
+  // other contents or another modified_time.
+  bool LoadIndex(std::string_view file_contents, std::string_view index,
+    std::int64_t modified_time);
+
+  // Opens file_contents, read from file_path, from the sidecar at
+  // xpm_index_path(file_path) when it matches the file. Otherwise parses the
+  // file, indexes every row and saves a fresh sidecar there for the next
+  // open, carrying on without one if it cannot be written. Returns whether
+  // the sidecar was used.
+  bool OpenIndexed(const std::filesystem::path& file_path,
+    std::string_view file_contents, bool xpm3);
+
+  // Writes the palette indices of the width by height region at (x, y) to
+  // out, starting each row stride elements after the last. Rows and keys are
+  // only checked as they are decoded, so a bad file can throw here.
+  void ReadRegion(int x, int y, int width, int height, std::uint32_t* out,
+    std::ptrdiff_t stride);
+};
+
+// Where OpenIndexed and xpm-cli index keep file_path's sidecar.
+std::filesystem::path xpm_index_path(const std::filesystem::path& file_path);
+
+// The modified time a sidecar for file_path is keyed by: its last write time.
+std::int64_t xpm_index_time(const std::filesystem::path& file_path);
\ No newline at end of file
@@ -0,0 +1,479 @@
+#include "xpm_parse.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include "x11_colours.h"
+
+void invalid_xpm_error(unsigned int line) {
+  // printf("Runtime error thrown on line: %d\n", line);
+  (void)line;
+
+  throw std::runtime_error("the specified XPM file is invalid");
+}
+
+// Counts line breaks as Xpm2Lines splits lines: "\r\n", a lone '\r' and a
+// lone '\n' are one break each.
+static constexpr XpmParseError locate_xpm_error(std::string_view file_contents,
+  XpmError error, std::size_t offset)
+{
+  XpmParseError result = {error, offset, 1, 0};
+  std::size_t line_start = 0;
+
+  for (std::size_t i = 0; i < offset; i++) {
+    const char ch = file_contents[i];
+
+    if (ch == '\n' || (ch == '\r' && (i + 1 == file_contents.size() ||
+      file_contents[i + 1] != '\n')))
+    {
+      result.line++;
+      line_start = i + 1;
+    }
+  }
+
+  result.column = offset - line_start + 1;
+
+  return result;
+}
+
+// The 'd' of "cd" is on line 3, column 2 whichever line endings are used.
+static_assert(locate_xpm_error("a\rb\rcd", XpmError::none, 5).line == 3 &&
+  locate_xpm_error("a\rb\rcd", XpmError::none, 5).column == 2);
+
+static_assert(locate_xpm_error("a\nb\ncd", XpmError::none, 5).line == 3 &&
+  locate_xpm_error("a\nb\ncd", XpmError::none, 5).column == 2);
+
+static_assert(locate_xpm_error("a\r\nb\r\ncd", XpmError::none, 7).line == 3 &&
+  locate_xpm_error("a\r\nb\r\ncd", XpmError::none, 7).column == 2);
+
+XpmParseError xpm_parse_error(std::string_view file_contents, XpmError error,
+  std::size_t offset)
+{
+  return locate_xpm_error(file_contents, error, offset);
+}
+
+std::size_t xpm_offset_of(std::string_view file_contents, std::string_view s,
+  std::size_t pos)
+{
+  const char* data = s.data();
+
+  if (data < file_contents.data() || data > file_contents.data() +
+    file_contents.size())
+  {
+    return pos;
+  }
+
+  return data - file_contents.data();
+}
+
+bool string_to_int(std::string_view s, int& result, const int base) {
+  auto [ptr, ec] { std::from_chars(s.data(), s.data() + s.size(), result, base)
+    };
+
+  if (ec == std::errc())
+    if (ptr == s.data() + s.size())
+      return true;
+
+  return false;
+}
+
+std::string_view next_token(std::string_view& s, std::string_view delims) {
+  const auto start_pos = s.find_first_not_of(delims);
+
+  if (start_pos == std::string_view::npos) {
+    s = {};
+
+    return {};
+  }
+
+  s.remove_prefix(start_pos);
+
+  const auto end_pos = std::min(s.find_first_of(delims), s.size());
+  const std::string_view token = s.substr(0, end_pos);
+
+  s.remove_prefix(end_pos);
+
+  return token;
+}
+
+bool is_xpm2_header(std::string_view line) {
+  const auto start_pos = line.find_first_not_of(" \t");
+
+  return start_pos != std::string_view::npos && line[start_pos] == '!';
+}
+
+bool parse_xpm_values(std::string_view line, XpmValues& values) {
+  values = {};
+
+  for (auto i = 0; i < 4; i++) {
+    const std::string_view raw_value = next_token(line, " \t");
+    int result;
+
+    if (raw_value.empty())
+      return false;
+
+    if (!string_to_int(raw_value, result))
+      return false;
+
+    if (result < 1)
+      return false;
+
+    switch (i) {
+    case 0:
+      values.width = result;
+
+      break;
+
+    case 1:
+      values.height = result;
+
+      break;
+
+    case 2:
+      values.colour_count = result;
+
+      break;
+
+    case 3:
+      values.chars_per_pixel = result;
+
+      break;
+    }
+  }
+
+  return true;
+}
+
+XpmValues parse_xpm_values(std::string_view line) {
+  XpmValues values;
+
+  if (!parse_xpm_values(line, values))
+    invalid_xpm_error(__LINE__);
+
+  return values;
+}
+
+bool xpm_colour_table_fits(const XpmValues& values, std::size_t remaining) {
+  return (std::size_t)values.colour_count <= remaining /
+    ((std::size_t)values.chars_per_pixel + 4);
+}
+
+// Validates and decodes eight hex digits at once, one per byte: the high bit
+// of each byte is set by adding an offset when the byte clears a bound, and
+// bytes between '0' and '9' or, lowercased, 'a' and 'f' are digits. digits
+// is padded with zeros to eight bytes, read in little-endian order like the
+// rest of the parser's loads. Returns false on any other character.
+static bool decode_hex_digits(std::string_view digits, std::uint64_t& nibbles)
+{
+  constexpr std::uint64_t ones = 0x0101010101010101;
+  constexpr std::uint64_t high_bits = ones * 0x80;
+  char bytes[8] = { '0', '0', '0', '0', '0', '0', '0', '0' };
+
+  std::memcpy(bytes, digits.data(), std::min<std::size_t>(digits.size(), 8));
+
+  std::uint64_t word;
+
+  std::memcpy(&word, bytes, 8);
+
+  if (word & high_bits)
+    return false;
+
+  const std::uint64_t lower = word | ones * 0x20;
+  const std::uint64_t numeric = (word + ones * (0x80 - '0')) &
+    ~(word + ones * (0x80 - '9' - 1)) & high_bits;
+
+  const std::uint64_t alphabetic = (lower + ones * (0x80 - 'a')) &
+    ~(lower + ones * (0x80 - 'f' - 1)) & high_bits;
+
+  if ((numeric | alphabetic) != high_bits)
+    return false;
+
+  nibbles = (word & ones * 0x0f) + (alphabetic >> 7) * 9;
+
+  return true;
+}
+
+// Parses the digits of #RGB, #RRGGBB, #RRRGGGBBB or #RRRRGGGGBBBB. As in
+// X11, the digits given are the most significant bits of each channel, so
+// #RGB reads as #R0G0B0 and the longer forms keep their top two digits.
+static bool parse_hex_colour(std::string_view digits, Rgba& rgba) {
+  if (digits.empty() || digits.size() > 12 || digits.size() % 3)
+    return false;
+
+  std::uint64_t nibbles[2] = {};
+
+  if (!decode_hex_digits(digits.substr(0, 8), nibbles[0]) ||
+    (digits.size() > 8 && !decode_hex_digits(digits.substr(8), nibbles[1])))
+  {
+    return false;
+  }
+
+  // Byte k of pairs is digit k followed by digit k + 1 as a whole byte, the
+  // next digit's nibble sliding under the current one.
+  const std::uint64_t pairs[2] = {
+    nibbles[0] << 4 | nibbles[0] >> 8 | nibbles[1] << 56,
+    nibbles[1] << 4 | nibbles[1] >> 8
+  };
+
+  const auto channel_digits = digits.size() / 3;
+
+  auto channel = [&](std::size_t i) {
+    const std::size_t k = i * channel_digits;
+    const std::uint64_t word = channel_digits == 1 ? nibbles[0] << 4 :
+      pairs[k / 8];
+
+    return (int)(word >> (k % 8 * 8) & 0xff);
+  };
+
+  rgba = { channel(0), channel(1), channel(2), 255 };
+
+  return true;
+}
+
+XpmError parse_xpm_colour(std::string_view line, int chars_per_pixel,
+  Rgba& rgba, XpmStats* stats)
+{
+  if ((int)line.size() < chars_per_pixel + 1)
+    return XpmError::invalid_colour;
+
+  std::string_view colour_type_and_value = line.substr(chars_per_pixel + 1);
+  const std::string_view raw_colour_type = next_token(colour_type_and_value);
+  const std::string_view colour = next_token(colour_type_and_value);
+
+  if (colour.empty())
+    return XpmError::invalid_colour;
+
+  if (raw_colour_type.size() != 1)
+    return XpmError::invalid_colour;
+
+  const char& colour_type = raw_colour_type[0];
+
+  if (colour_type == 's' || colour_type == 'm' || colour_type == 'g')
+    return XpmError::unsupported_colour_type;
+
+  if (colour_type != 'c')
+    return XpmError::invalid_colour;
+
+  rgba = {};
+
+  if (colour[0] == '#') {
+    if (!parse_hex_colour(colour.substr(1), rgba))
+      return XpmError::invalid_colour;
+  }
+
+  else {
+    // A name runs to the end of the line, and its words are matched where
+    // they lie with the spaces between them skipped.
+    std::string_view name(colour.data(), line.data() + line.size() -
+      colour.data());
+
+    name = name.substr(0, name.find_last_not_of(' ') + 1);
+
+    if (!x11_names_equal(name, "none")) {
+      XpmPhaseTimer timer(stats ? &stats->x11_lookups : nullptr);
+      const X11Colour* x11_colour = find_x11_colour(name);
+
+      if (stats) {
+        stats->x11_lookups.bytes_scanned += name.size();
+        stats->x11_lookup_count++;
+      }
+
+      if (!x11_colour)
+        return XpmError::unknown_colour_name;
+
+      rgba = { x11_colour->rgb.r, x11_colour->rgb.g, x11_colour->rgb.b, 255 };
+    }
+  }
+
+  return XpmError::none;
+}
+
+Rgba parse_xpm_colour(std::string_view line, int chars_per_pixel,
+  XpmStats* stats)
+{
+  Rgba rgba;
+  const XpmError error = parse_xpm_colour(line, chars_per_pixel, rgba, stats);
+
+  if (error == XpmError::unsupported_colour_type) {
+    std::string_view colour_type_and_value = line.substr(chars_per_pixel + 1);
+    const char colour_type = next_token(colour_type_and_value)[0];
+
+    throw std::runtime_error((std::string)(colour_type == 's' ? "symbolic" :
+      colour_type == 'm' ? "monochrome" : "greyscale") +
+      " colours are not yet supported");
+  }
+
+  if (error != XpmError::none)
+    invalid_xpm_error(__LINE__);
+
+  return rgba;
+}
+
+Xpm3Lines::Xpm3Lines(std::string_view s, bool keep_elements,
+  std::pmr::memory_resource* memory_resource) : _s(s), _pos(0),
+  _keep_elements(keep_elements), _malformed(false),
+  _unescaped(memory_resource)
+{
+  // Everything before the array's opening brace is declaration. Without one
+  // the walker is left at the end, where next reports the array malformed.
+  while (true) {
+    skip_comments_and_whitespace();
+
+    if (_pos >= _s.size() || _s[_pos++] == '{')
+      break;
+  }
+}
+
+void Xpm3Lines::skip_comments_and_whitespace() {
+  while (_pos < _s.size()) {
+    const char ch = _s[_pos];
+
+    if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\f' ||
+      ch == '\v')
+    {
+      _pos++;
+    }
+
+    else if (_s.compare(_pos, 2, "/*") == 0) {
+      const auto end_pos = _s.find("*/", _pos + 2);
+
+      _pos = end_pos == std::string_view::npos ? _s.size() : end_pos + 2;
+    }
+
+    else if (_s.compare(_pos, 2, "//") == 0) {
+      const auto end_pos = _s.find('\n', _pos + 2);
+
+      _pos = end_pos == std::string_view::npos ? _s.size() : end_pos + 1;
+    }
+
+    else
+      break;
+  }
+}
+
+static void append_unescaped(std::pmr::string& result,
+  std::string_view literal)
+{
+  for (std::string_view::size_type i = 0; i < literal.size(); i++) {
+    if (literal[i] != '\\' || i + 1 == literal.size()) {
+      result.push_back(literal[i]);
+
+      continue;
+    }
+
+    switch (const char ch = literal[++i]) {
+    case 'n':
+      result.push_back('\n');
+
+      break;
+
+    case 't':
+      result.push_back('\t');
+
+      break;
+
+    case 'r':
+      result.push_back('\r');
+
+      break;
+
+    default:
+      result.push_back(ch);
+
+      break;
+    }
+  }
+}
+
+bool Xpm3Lines::next(std::string_view& line) {
+  _malformed = false;
+
+  while (true) {
+    skip_comments_and_whitespace();
+
+    // The closing brace is required; running out of input first means the
+    // file was truncated.
+    if (_pos >= _s.size()) {
+      _malformed = true;
+
+      return false;
+    }
+
+    if (_s[_pos] == '}')
+      return false;
+
+    if (_s[_pos] != '"') {
+      _pos++;
+
+      continue;
+    }
+
+    std::string_view element;
+    std::pmr::string* unescaped = nullptr;
+
+    while (_pos < _s.size() && _s[_pos] == '"') {
+      const auto start_pos = ++_pos;
+      const char* const end = _s.data() + _s.size();
+      const char* chars = _s.data() + start_pos;
+      const char* quote;
+      bool escaped = false;
+
+      // The closing quote is found with memchr rather than a byte at a time,
+      // and only a backslash before it means the quote may be escaped.
+      while (true) {
+        quote = (const char*)std::memchr(chars, '"', end - chars);
+
+        if (!quote) {
+          _pos = _s.size();
+          _malformed = true;
+
+          return false;
+        }
+
+        const auto* backslash = (const char*)std::memchr(chars, '\\',
+          quote - chars);
+
+        if (!backslash)
+          break;
+
+        escaped = true;
+        chars = backslash + 2;
+      }
+
+      _pos = quote - _s.data();
+
+      const std::string_view literal = _s.substr(start_pos,
+        _pos - start_pos);
+
+      _pos++;
+
+      if (!unescaped && element.empty() && !escaped)
+        element = literal;
+
+      else {
+        if (!unescaped) {
+          if (_keep_elements || _unescaped.empty())
+            _unescaped.emplace_back();
+
+          unescaped = &_unescaped.back();
+          unescaped->assign(element);
+        }
+
+        append_unescaped(*unescaped, literal);
+      }
+
+      skip_comments_and_whitespace();
+    }
+
+    if (unescaped)
+      element = *unescaped;
+
+    // Empty elements carry nothing, as with blank XPM2 lines.
+    if (!element.empty()) {
+      line = element;
+
+      return true;
+    }
+  }
+}
\ No newline at end of file
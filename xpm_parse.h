@@ -0,0 +1,302 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include "key_table.h"
+#include "rgb.h"
+#include "simd_decode.h"
+#include "xpm.h"
+#include "xpm_stats.h"
+
+// Building blocks shared by the XPM decoders. Anything that rejects its input
+// either returns why or does so through invalid_xpm_error.
+
+struct XpmValues {
+  int width;
+  int height;
+  int colour_count;
+  int chars_per_pixel;
+};
+
+[[noreturn]] void invalid_xpm_error(unsigned int line);
+
+// Returns error at offset into file_contents, finding its line and column.
+XpmParseError xpm_parse_error(std::string_view file_contents, XpmError error,
+  std::size_t offset);
+
+// The offset of s in file_contents, or pos if s is not a view of it.
+std::size_t xpm_offset_of(std::string_view file_contents, std::string_view s,
+  std::size_t pos);
+
+bool string_to_int(std::string_view s, int& result, const int base = 10);
+
+// Pops the next run of characters not in delims off the front of s, returning
+// an empty view once s is exhausted.
+std::string_view next_token(std::string_view& s,
+  std::string_view delims = " ");
+
+// Whether line is the optional "! XPM2" line that precedes the values.
+bool is_xpm2_header(std::string_view line);
+
+XpmValues parse_xpm_values(std::string_view line);
+
+// As above, returning false instead of throwing.
+bool parse_xpm_values(std::string_view line, XpmValues& values);
+
+// Whether remaining bytes could hold the colour table values declares, each
+// line being at least a key and " c x", so that nothing is sized from a
+// count the input cannot back.
+bool xpm_colour_table_fits(const XpmValues& values, std::size_t remaining);
+
+// Parses the colour of one colour table line; its key is the first
+// chars_per_pixel characters. X11 name lookups are recorded in stats, if any.
+Rgba parse_xpm_colour(std::string_view line, int chars_per_pixel,
+  XpmStats* stats = nullptr);
+
+// As above, returning why the line was rejected instead of throwing.
+XpmError parse_xpm_colour(std::string_view line, int chars_per_pixel,
+  Rgba& rgba, XpmStats* stats = nullptr);
+
+// Batches the small pieces the encoders produce into large writes to sink.
+class SinkBuffer {
+  const XpmSink& _sink;
+  std::string _buffer;
+
+public:
+  explicit SinkBuffer(const XpmSink& sink) : _sink(sink) {
+    _buffer.reserve(0x10000);
+  }
+
+  void write(std::string_view s) {
+    if (_buffer.size() + s.size() > _buffer.capacity()) {
+      flush();
+
+      if (s.size() > _buffer.capacity()) {
+        _sink(s);
+
+        return;
+      }
+    }
+
+    _buffer += s;
+  }
+
+  // Writes s for the inside of a C string literal, escaping quotes and
+  // backslashes so that it reads back as the same bytes.
+  void write_escaped(std::string_view s) {
+    for (auto pos = s.find_first_of("\"\\"); pos != std::string_view::npos;
+      pos = s.find_first_of("\"\\"))
+    {
+      write(s.substr(0, pos));
+      write(s[pos] == '"' ? "\\\"" : "\\\\");
+      s.remove_prefix(pos + 1);
+    }
+
+    write(s);
+  }
+
+  void flush() {
+    if (!_buffer.empty())
+      _sink(_buffer);
+
+    _buffer.clear();
+  }
+};
+
+// Walks the non-empty lines of an XPM2 buffer in a single forward pass,
+// treating "\r\n", "\r" and "\n" alike and yielding views into the buffer.
+class Xpm2Lines {
+  std::string_view _s;
+  std::string_view::size_type _pos;
+
+public:
+  static constexpr bool has_header_line = true;
+
+  explicit Xpm2Lines(std::string_view s) : _s(s), _pos(0) {}
+
+  bool next(std::string_view& line) {
+    while (_pos < _s.size()) {
+      const auto start_pos = _pos;
+
+      while (_pos < _s.size() && _s[_pos] != '\n' && _s[_pos] != '\r')
+        _pos++;
+
+      const auto end_pos = _pos;
+
+      if (_pos < _s.size())
+        _pos++;
+
+      if (end_pos > start_pos) {
+        line = _s.substr(start_pos, end_pos - start_pos);
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // XPM2 has no structure beyond its lines to get wrong.
+  bool malformed() const {
+    return false;
+  }
+
+  std::string_view::size_type remaining() const {
+    return _s.size() - _pos;
+  }
+
+  // Offsets into the buffer; seeking to a position recorded before a call to
+  // next makes the walker yield the same line again.
+  std::string_view::size_type position() const {
+    return _pos;
+  }
+
+  void seek(std::string_view::size_type pos) {
+    _pos = pos;
+  }
+};
+
+// Walks the elements of an XPM3 C array in a single forward pass, skipping
+// comments and joining adjacent string literals as the C compiler would.
+// Elements made of one literal without escapes are views into the buffer;
+// any others are unescaped into storage owned by the walker, which keeps
+// every element it yields valid for as long as the walker lives, unless
+// keep_elements is false, in which case each element is only valid until the
+// next call and the storage is reused. That storage comes from
+// memory_resource.
+class Xpm3Lines {
+  std::string_view _s;
+  std::string_view::size_type _pos;
+  bool _keep_elements;
+  bool _malformed;
+  std::pmr::deque<std::pmr::string> _unescaped;
+
+  void skip_comments_and_whitespace();
+
+public:
+  static constexpr bool has_header_line = false;
+
+  explicit Xpm3Lines(std::string_view s, bool keep_elements = true,
+    std::pmr::memory_resource* memory_resource =
+      std::pmr::get_default_resource());
+  bool next(std::string_view& line);
+
+  // Whether the last call to next returned false because the array is cut
+  // short or a literal is unterminated, rather than at the closing brace.
+  bool malformed() const {
+    return _malformed;
+  }
+
+  std::string_view::size_type remaining() const {
+    return _s.size() - _pos;
+  }
+
+  std::string_view::size_type position() const {
+    return _pos;
+  }
+
+  void seek(std::string_view::size_type pos) {
+    _pos = pos;
+  }
+};
+
+// Forwards to another line walker, recording the lines it yields in stats.
+template <typename Lines>
+class XpmTracedLines {
+  Lines& _lines;
+  XpmStats& _stats;
+
+public:
+  static constexpr bool has_header_line = Lines::has_header_line;
+
+  XpmTracedLines(Lines& lines, XpmStats& stats) : _lines(lines), _stats(stats)
+  {
+
+  }
+
+  bool next(std::string_view& line) {
+#if XPM_STATS
+    const auto remaining_before = _lines.remaining();
+    XpmPhaseTimer timer(&_stats.lines);
+    const bool has_line = _lines.next(line);
+
+    _stats.lines.bytes_scanned += remaining_before - _lines.remaining();
+    _stats.line_count += has_line;
+
+    return has_line;
+#else
+    return _lines.next(line);
+#endif
+  }
+
+  bool malformed() const {
+    return _lines.malformed();
+  }
+
+  std::string_view::size_type remaining() const {
+    return _lines.remaining();
+  }
+
+  std::string_view::size_type position() const {
+    return _lines.position();
+  }
+};
+
+// Translates a row of width keys into palette indices, returning false if any
+// key is undefined. One- and two-character keys are read straight out of the
+// table's direct index, the former through the SIMD translate_keys kernel;
+// CharsPerPixel 0 handles every other width.
+template <int CharsPerPixel, typename Index>
+bool decode_xpm_row(std::string_view row, const KeyTable& key_table,
+  Index* out, int width)
+{
+  const auto* chars = (const unsigned char*)row.data();
+  std::uint32_t undefined = 0;
+
+  if constexpr (CharsPerPixel == 1)
+    return translate_keys(chars, key_table.direct(), out, width);
+
+  else if constexpr (CharsPerPixel == 2) {
+    const std::uint32_t* direct = key_table.direct();
+
+    for (auto c = 0; c < width; c++) {
+      const std::uint32_t index = direct[chars[c * 2] | chars[c * 2 + 1] << 8];
+
+      undefined |= index;
+      out[c] = (Index)index;
+    }
+  }
+
+  else {
+    const auto chars_per_pixel = key_table.chars_per_pixel();
+
+    for (auto c = 0; c < width; c++) {
+      const std::uint32_t index = key_table.find(row.substr(
+        (std::size_t)c * chars_per_pixel, chars_per_pixel));
+
+      undefined |= index;
+      out[c] = (Index)index;
+    }
+  }
+
+  // Palette indices never reach the top bit, so it is only set by npos.
+  return !(undefined >> 31);
+}
+
+template <typename Index>
+using XpmRowDecoder = bool (*)(std::string_view row, const KeyTable& key_table,
+  Index* out, int width);
+
+template <typename Index>
+XpmRowDecoder<Index> xpm_row_decoder(int chars_per_pixel) {
+  if (chars_per_pixel == 1)
+    return decode_xpm_row<1, Index>;
+
+  if (chars_per_pixel == 2)
+    return decode_xpm_row<2, Index>;
+
+  return decode_xpm_row<0, Index>;
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "xpm_stats.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if XPM_STATS
+static thread_local std::size_t allocation_count = 0;
+static thread_local std::size_t allocated_bytes = 0;
+static thread_local XpmAllocationScope* joined_scope = nullptr;
+
+static void count_allocations(std::size_t count, std::size_t bytes) {
+  allocation_count += count;
+  allocated_bytes += bytes;
+
+  if (joined_scope)
+    joined_scope->add(count, bytes);
+}
+
+void* operator new(std::size_t size) {
+  count_allocations(1, size);
+
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+// Over-aligned requests, such as those memory resources make, come through
+// here.
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  const auto align = (std::size_t)alignment;
+
+  count_allocations(1, size);
+
+#ifdef _WIN32
+  if (void* p = _aligned_malloc(size ? size : 1, align))
+    return p;
+#else
+  if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align))
+    return p;
+#endif
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+#ifdef _WIN32
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment)
+  noexcept
+{
+  operator delete(p, alignment);
+}
+
+XpmAllocationScope::XpmAllocationScope() : _allocation_count(0),
+  _allocated_bytes(0)
+{
+
+}
+
+// Passed on to any scope the creating thread has joined in turn, so nested
+// parallel_for calls add up.
+XpmAllocationScope::~XpmAllocationScope() {
+  count_allocations(_allocation_count, _allocated_bytes);
+}
+
+void XpmAllocationScope::add(std::size_t count, std::size_t bytes) {
+  _allocation_count.fetch_add(count, std::memory_order_relaxed);
+  _allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void XpmAllocationScope::join() {
+  joined_scope = this;
+}
+
+std::size_t xpm_allocation_count() {
+  return allocation_count;
+}
+
+std::size_t xpm_allocated_bytes() {
+  return allocated_bytes;
+}
+#endif
+
+static void append_phase_json(std::string& json, const char* name,
+  const XpmPhaseStats& phase)
+{
+  char buffer[256];
+
+  std::snprintf(buffer, sizeof(buffer), "\"%s\":{\"seconds\":%.9f,"
+    "\"bytes_scanned\":%zu,\"allocations\":%zu,\"allocated_bytes\":%zu},",
+    name, phase.seconds, phase.bytes_scanned, phase.allocations,
+    phase.allocated_bytes);
+
+  json += buffer;
+}
+
+std::string xpm_stats_json(const XpmStats& stats) {
+  std::string json = "{";
+
+  append_phase_json(json, "header", stats.header);
+  append_phase_json(json, "colours", stats.colours);
+  append_phase_json(json, "x11_lookups", stats.x11_lookups);
+  append_phase_json(json, "pixels", stats.pixels);
+  append_phase_json(json, "lines", stats.lines);
+
+  char buffer[256];
+
+  std::snprintf(buffer, sizeof(buffer), "\"line_count\":%zu,"
+    "\"colour_count\":%zu,\"x11_lookup_count\":%zu,\"pixel_count\":%zu}",
+    stats.line_count, stats.colour_count, stats.x11_lookup_count,
+    stats.pixel_count);
+
+  return json + buffer;
+}
\ No newline at end of file
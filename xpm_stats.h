@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+// Building with XPM_STATS defined as 1 records where each parse spends its
+// time and memory. Otherwise the statistics stay zero and the recording
+// compiles away.
+#ifndef XPM_STATS
+#define XPM_STATS 0
+#endif
+
+struct XpmPhaseStats {
+  double seconds = 0;
+  std::size_t bytes_scanned = 0;
+  std::size_t allocations = 0;
+  std::size_t allocated_bytes = 0;
+};
+
+struct XpmStats {
+  // The optional XPM2 header and the values line.
+  XpmPhaseStats header;
+  // The colour table, including its X11 name lookups.
+  XpmPhaseStats colours;
+  XpmPhaseStats x11_lookups;
+  XpmPhaseStats pixels;
+  // Finding and unescaping lines, which is part of every other phase.
+  XpmPhaseStats lines;
+  std::size_t line_count = 0;
+  std::size_t colour_count = 0;
+  std::size_t x11_lookup_count = 0;
+  std::size_t pixel_count = 0;
+};
+
+std::string xpm_stats_json(const XpmStats& stats);
+
+#if XPM_STATS
+// Heap allocations made so far by the calling thread and their total size,
+// counted by the replacement operator new in xpm_stats.cpp. Those of the
+// threads a parallel_for started are included once it returns.
+std::size_t xpm_allocation_count();
+std::size_t xpm_allocated_bytes();
+
+// Adds up the allocations of the threads that join it and, when destroyed,
+// credits them to the thread that created it, as if that thread had made
+// them. parallel_for opens one around its workers.
+class XpmAllocationScope {
+  std::atomic<std::size_t> _allocation_count;
+  std::atomic<std::size_t> _allocated_bytes;
+
+public:
+  XpmAllocationScope();
+  ~XpmAllocationScope();
+
+  // Counts count allocations of bytes in total; safe from any thread.
+  void add(std::size_t count, std::size_t bytes);
+
+  // Counts the calling thread's allocations here for the rest of its life,
+  // which must end before the scope's.
+  void join();
+
+  XpmAllocationScope(const XpmAllocationScope&) = delete;
+  XpmAllocationScope& operator=(const XpmAllocationScope&) = delete;
+};
+#endif
+
+// Adds the wall time and allocations of its lifetime to phase, if any.
+class XpmPhaseTimer {
+#if XPM_STATS
+  XpmPhaseStats* _phase;
+  std::chrono::steady_clock::time_point _start;
+  std::size_t _allocations;
+  std::size_t _allocated_bytes;
+
+public:
+  explicit XpmPhaseTimer(XpmPhaseStats* phase) : _phase(phase),
+    _start(std::chrono::steady_clock::now()),
+    _allocations(xpm_allocation_count()),
+    _allocated_bytes(xpm_allocated_bytes())
+  {
+
+  }
+
+  ~XpmPhaseTimer() {
+    if (!_phase)
+      return;
+
+    const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - _start;
+
+    _phase->seconds += elapsed.count();
+    _phase->allocations += xpm_allocation_count() - _allocations;
+    _phase->allocated_bytes += xpm_allocated_bytes() - _allocated_bytes;
+  }
+
+  XpmPhaseTimer(const XpmPhaseTimer&) = delete;
+  XpmPhaseTimer& operator=(const XpmPhaseTimer&) = delete;
+#else
+public:
+  explicit XpmPhaseTimer(XpmPhaseStats*) {}
+#endif
+};
\ No newline at end of file
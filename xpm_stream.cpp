@@ -0,0 +1,267 @@
+#include "xpm_stream.h"
+#include <algorithm>
+#include <utility>
+#include "x11_colours.h"
+#include "xpm_parse.h"
+
+XpmStreamDecoder::XpmStreamDecoder(RowCallback on_row) :
+  _on_row(std::move(on_row)), _state(State::header), _width(0), _height(0),
+  _colour_count(0), _chars_per_pixel(0), _rows_decoded(0), _offset(0),
+  _line(1), _after_cr(false), _error()
+{
+
+}
+
+const int& XpmStreamDecoder::width() const {
+  return _width;
+}
+
+const int& XpmStreamDecoder::height() const {
+  return _height;
+}
+
+const int& XpmStreamDecoder::colour_count() const {
+  return _colour_count;
+}
+
+const int& XpmStreamDecoder::chars_per_pixel() const {
+  return _chars_per_pixel;
+}
+
+const std::vector<Rgba>& XpmStreamDecoder::palette() const {
+  return _palette;
+}
+
+std::string_view XpmStreamDecoder::key(std::uint32_t index) const {
+  return std::string_view(_keys).substr((std::size_t)index * _chars_per_pixel,
+    _chars_per_pixel);
+}
+
+bool XpmStreamDecoder::done() const {
+  return _state == State::done;
+}
+
+const XpmParseError& XpmStreamDecoder::error() const {
+  return _error;
+}
+
+// pos is relative to the start of the line being gathered.
+bool XpmStreamDecoder::Fail(XpmError error, std::size_t pos) {
+  _error = {error, _offset + pos, _line, pos + 1};
+
+  return false;
+}
+
+bool XpmStreamDecoder::ParseLine(std::string_view line) {
+  if (line.empty())
+    return true;
+
+  switch (_state) {
+  case State::header:
+    _state = State::values;
+
+    if (is_xpm2_header(line))
+      break;
+
+    [[fallthrough]];
+
+  case State::values: {
+      XpmValues values;
+
+      if (!parse_xpm_values(line, values))
+        return Fail(XpmError::invalid_values, 0);
+
+      _width = values.width;
+      _height = values.height;
+      _colour_count = values.colour_count;
+      _chars_per_pixel = values.chars_per_pixel;
+
+      // The header cannot be checked against the input size here, so the
+      // key table starts small and grows as colours actually arrive.
+      _key_table.emplace(_chars_per_pixel, std::min(_colour_count, 0x10000));
+      _state = State::colours;
+    }
+
+    break;
+
+  case State::colours: {
+      Rgba rgba;
+      const XpmError error = parse_xpm_colour(line, _chars_per_pixel, rgba);
+
+      if (error != XpmError::none)
+        return Fail(error, 0);
+
+      const std::string_view chars = line.substr(0, _chars_per_pixel);
+
+      _key_table->insert(chars, (std::uint32_t)_palette.size());
+      _keys += chars;
+      _palette.push_back(rgba);
+
+      if ((int)_palette.size() == _colour_count)
+        _state = State::pixels;
+    }
+
+    break;
+
+  case State::pixels:
+    if (line.size() != (unsigned long long)_width * _chars_per_pixel)
+      return Fail(XpmError::invalid_row_width, 0);
+
+    _row.resize(_width);
+
+    if (!xpm_row_decoder<std::uint32_t>(_chars_per_pixel)(line, *_key_table,
+      _row.data(), _width))
+    {
+      std::size_t pos = 0;
+
+      while (_key_table->find(line.substr(pos, _chars_per_pixel)) !=
+        KeyTable::npos)
+      {
+        pos += _chars_per_pixel;
+      }
+
+      return Fail(XpmError::undefined_key, pos);
+    }
+
+    _on_row(_rows_decoded, _row.data());
+
+    if (++_rows_decoded == _height)
+      _state = State::done;
+
+    break;
+
+  case State::done:
+    return Fail(XpmError::trailing_data, 0);
+  }
+
+  return true;
+}
+
+// Rejects the line being gathered if size bytes of it are already more than
+// any valid line in its place could hold. Values are at most ten digits, and
+// a colour is at most a 13-character hex value or the longest X11 name with
+// a space between each of its letters.
+bool XpmStreamDecoder::CheckLineSize(std::size_t size) {
+  static constexpr std::size_t max_values_size = 4 * 11;
+
+  static constexpr std::size_t max_colour_size = []() {
+    std::size_t result = 13;
+
+    for (const X11Colour& x11_colour : x11_colours)
+      result = std::max(result, x11_colour.name.size() * 2);
+
+    return result;
+  }();
+
+  switch (_state) {
+  case State::header:
+  case State::values:
+    if (size > max_values_size + xpm_stream_line_slack)
+      return Fail(XpmError::invalid_values, 0);
+
+    break;
+
+  case State::colours:
+    if (size > (unsigned long long)_chars_per_pixel + 3 + max_colour_size +
+      xpm_stream_line_slack)
+    {
+      return Fail(XpmError::invalid_colour, 0);
+    }
+
+    break;
+
+  case State::pixels:
+    // A pixel row can never outgrow its declared width.
+    if (size > (unsigned long long)_width * _chars_per_pixel)
+      return Fail(XpmError::invalid_row_width, 0);
+
+    break;
+
+  case State::done:
+    // Any line that is not empty is trailing data.
+    if (size)
+      return Fail(XpmError::trailing_data, 0);
+
+    break;
+  }
+
+  return true;
+}
+
+bool XpmStreamDecoder::Feed(std::string_view chunk) {
+  if (_error.error != XpmError::none)
+    return false;
+
+  while (!chunk.empty()) {
+    // A plain loop, as in Xpm2Lines, beats find_first_of's per-character
+    // search of the delimiters.
+    std::size_t end_pos = 0;
+
+    while (end_pos < chunk.size() && chunk[end_pos] != '\n' &&
+      chunk[end_pos] != '\r')
+    {
+      end_pos++;
+    }
+
+    if (end_pos == chunk.size()) {
+      // An overlong partial line is rejected before it is buffered.
+      if (!CheckLineSize(_partial_line.size() + chunk.size()))
+        return false;
+
+      _partial_line += chunk;
+      _after_cr = false;
+
+      return true;
+    }
+
+    bool parsed;
+    std::size_t line_size = _partial_line.size() + end_pos;
+
+    // Checked whole as well, so that whether a line is accepted does not
+    // depend on how the input was split into chunks.
+    if (!CheckLineSize(line_size))
+      return false;
+
+    if (_partial_line.empty())
+      parsed = ParseLine(chunk.substr(0, end_pos));
+
+    else {
+      _partial_line += chunk.substr(0, end_pos);
+      parsed = ParseLine(_partial_line);
+      _partial_line.clear();
+    }
+
+    if (!parsed)
+      return false;
+
+    // The '\n' of a "\r\n" ends no further line.
+    if (!(_after_cr && !line_size && chunk[end_pos] == '\n'))
+      _line++;
+
+    _after_cr = chunk[end_pos] == '\r';
+    _offset += line_size + 1;
+    chunk.remove_prefix(end_pos + 1);
+  }
+
+  return true;
+}
+
+bool XpmStreamDecoder::Finish() {
+  if (_error.error != XpmError::none || !ParseLine(_partial_line))
+    return false;
+
+  const std::size_t pos = _partial_line.size();
+
+  _partial_line.clear();
+
+  if (_state == State::done)
+    return true;
+
+  if (_state == State::colours)
+    return Fail(XpmError::missing_colour, pos);
+
+  if (_state == State::pixels)
+    return Fail(XpmError::missing_row, pos);
+
+  return Fail(XpmError::missing_values, pos);
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "key_table.h"
+#include <optional>
+#include <string>
+#include <string_view>
+#include "rgb.h"
+#include <vector>
+#include "xpm.h"
+
+inline constexpr std::size_t xpm_stream_line_slack = 0x1000;
+
+// A push-style XPM2 decoder. Bytes are fed in chunks of any size, the values
+// and colour table are parsed as soon as their lines are complete, and each
+// pixel row is handed to a callback as palette indices once its line has
+// arrived. Only the palette, one partial line and one decoded row are held,
+// so memory use does not depend on the image height. Invalid input is
+// reported as an XpmParseError, located as Xpm::TryParseXpm2 locates it.
+// So that no input can grow the partial line without bound, a line is
+// rejected once it is longer than any valid one in its place: a pixel row
+// beyond its declared width, and any other line beyond the longest layout
+// of its tokens plus xpm_stream_line_slack bytes of spacing, which
+// TryParseXpm2 would accept.
+class XpmStreamDecoder {
+public:
+  using RowCallback = std::function<void(int row,
+    const std::uint32_t* indices)>;
+
+private:
+  enum class State
+  {
+    header,
+    values,
+    colours,
+    pixels,
+    done,
+  };
+
+  RowCallback _on_row;
+  State _state;
+  int _width;
+  int _height;
+  int _colour_count;
+  int _chars_per_pixel;
+  std::string _keys;
+  std::vector<Rgba> _palette;
+  std::optional<KeyTable> _key_table;
+  std::string _partial_line;
+  std::vector<std::uint32_t> _row;
+  int _rows_decoded;
+  // Where the line being gathered starts in the input, and its line number.
+  std::size_t _offset;
+  std::size_t _line;
+  bool _after_cr;
+  XpmParseError _error;
+
+  bool Fail(XpmError error, std::size_t pos);
+  bool ParseLine(std::string_view line);
+  bool CheckLineSize(std::size_t size);
+
+public:
+  explicit XpmStreamDecoder(RowCallback on_row);
+  const int& width() const;
+  const int& height() const;
+  const int& colour_count() const;
+  const int& chars_per_pixel() const;
+  const std::vector<Rgba>& palette() const;
+  std::string_view key(std::uint32_t index) const;
+  bool done() const;
+  // Why the input was rejected; its error is none while the input is valid.
+  const XpmParseError& error() const;
+  // Returns false once the input is known to be invalid, after which further
+  // chunks are ignored.
+  bool Feed(std::string_view chunk);
+  // Parses any final unterminated line, returning false if the image is
+  // invalid or incomplete.
+  bool Finish();
+};
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "xpm_validate.h"
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include "simd_decode.h"
+#include "xpm_parse.h"
+
+template <typename Lines>
+static XpmValidation validate(std::string_view file_contents, Lines& lines,
+  XpmValidation& result)
+{
+  std::string_view line;
+
+  auto fail = [&result, file_contents](XpmError error, std::size_t offset) {
+    static_cast<XpmParseError&>(result) = xpm_parse_error(file_contents,
+      error, offset);
+
+    return result;
+  };
+
+  auto offset_of = [file_contents, &lines](std::string_view s) {
+    return xpm_offset_of(file_contents, s, lines.position());
+  };
+
+  auto missing = [&fail, &lines](XpmError error) {
+    return fail(lines.malformed() ? XpmError::syntax : error,
+      lines.position());
+  };
+
+  if (!lines.next(line))
+    return missing(XpmError::missing_values);
+
+  if (Lines::has_header_line && is_xpm2_header(line) && !lines.next(line))
+    return missing(XpmError::missing_values);
+
+  XpmValues values;
+
+  if (!parse_xpm_values(line, values))
+    return fail(XpmError::invalid_values, offset_of(line));
+
+  result.width = values.width;
+  result.height = values.height;
+  result.colour_count = values.colour_count;
+  result.chars_per_pixel = values.chars_per_pixel;
+
+  const auto chars_per_pixel = (std::size_t)values.chars_per_pixel;
+
+  // As when parsing, the declared sizes are checked against the input before
+  // anything is sized from them.
+  if (!xpm_colour_table_fits(values, lines.remaining()))
+    return fail(XpmError::missing_colour, file_contents.size());
+
+  // Keys of one or two characters are tracked in tables on the stack: one
+  // character keys in the form translate_keys takes, two character keys as a
+  // byte per key so that rows are checked without branching per pixel.
+  std::uint32_t direct[0x100];
+  std::uint8_t defined[0x10000] = {};
+  std::uint8_t translated[0x400];
+  std::optional<KeyTable> key_table;
+
+  std::fill(direct, direct + 0x100, KeyTable::npos);
+
+  auto pack = [chars_per_pixel](std::string_view key) {
+    return (std::size_t)(unsigned char)key[0] | (chars_per_pixel == 2 ?
+      (std::size_t)(unsigned char)key[1] << 8 : 0);
+  };
+
+  if (chars_per_pixel > 2)
+    key_table.emplace(values.chars_per_pixel, values.colour_count);
+
+  for (auto i = 0; i < values.colour_count; i++) {
+    if (!lines.next(line))
+      return missing(XpmError::missing_colour);
+
+    Rgba rgba;
+    const XpmError error = parse_xpm_colour(line, values.chars_per_pixel,
+      rgba);
+
+    if (error != XpmError::none)
+      return fail(error, offset_of(line));
+
+    const std::string_view key = line.substr(0, chars_per_pixel);
+
+    // As when parsing, the first definition stands.
+    if (key_table ? !key_table->insert(key, (std::uint32_t)i) :
+      defined[pack(key)])
+    {
+      if (result.warning.error == XpmError::none) {
+        result.warning = xpm_parse_error(file_contents,
+          XpmError::duplicate_key, offset_of(line));
+      }
+    }
+
+    if (!key_table)
+      defined[pack(key)] = 1;
+
+    if (chars_per_pixel == 1)
+      direct[pack(key)] = 0;
+  }
+
+  const auto row_size = (unsigned long long)values.width * chars_per_pixel;
+
+  if (row_size > lines.remaining() / values.height)
+    return fail(XpmError::missing_row, file_contents.size());
+
+  for (auto r = 0; r < values.height; r++) {
+    if (!lines.next(line))
+      return missing(XpmError::missing_row);
+
+    if (line.size() != row_size)
+      return fail(XpmError::invalid_row_width, offset_of(line));
+
+    const auto* chars = (const unsigned char*)line.data();
+    std::size_t pos = 0;
+
+    // One and two character rows are checked whole first and only searched
+    // for the undefined key when the check fails.
+    if (chars_per_pixel == 1) {
+      while (pos < line.size()) {
+        const auto count = std::min(line.size() - pos, sizeof translated);
+
+        if (!translate_keys(chars + pos, direct, translated, (int)count))
+          break;
+
+        pos += count;
+      }
+
+      while (pos < line.size() && defined[chars[pos]])
+        pos++;
+    }
+
+    else if (!key_table) {
+      std::uint8_t all_defined = 1;
+
+      for (std::size_t c = 0; c < line.size(); c += 2)
+        all_defined &= defined[chars[c] | chars[c + 1] << 8];
+
+      if (all_defined)
+        pos = line.size();
+
+      while (pos < line.size() && defined[chars[pos] | chars[pos + 1] << 8])
+        pos += 2;
+    }
+
+    else {
+      while (pos < line.size() && key_table->find(line.substr(pos,
+        chars_per_pixel)) != KeyTable::npos)
+      {
+        pos += chars_per_pixel;
+      }
+    }
+
+    if (pos < line.size())
+      return fail(XpmError::undefined_key, offset_of(line.substr(pos)));
+  }
+
+  if (lines.next(line))
+    return fail(XpmError::trailing_data, offset_of(line));
+
+  if (lines.malformed())
+    return fail(XpmError::syntax, lines.position());
+
+  return result;
+}
+
+XpmValidation validate_xpm2(std::string_view file_contents) {
+  XpmValidation result = {};
+  Xpm2Lines lines(file_contents);
+
+  return validate(file_contents, lines, result);
+}
+
+XpmValidation validate_xpm3(std::string_view file_contents) {
+  XpmValidation result = {};
+  Xpm3Lines lines(file_contents, false);
+
+  return validate(file_contents, lines, result);
+}
\ No newline at end of file
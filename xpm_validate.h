@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string_view>
+#include "xpm.h"
+
+// The error, if any, and the values the file declares.
+struct XpmValidation : XpmParseError {
+  // Zero where they could not be read.
+  int width;
+  int height;
+  int colour_count;
+  int chars_per_pixel;
+  // The first problem found that parsing accepts, such as a key defined
+  // twice; its error is none if there was none.
+  XpmParseError warning;
+
+  bool valid() const {
+    return error == XpmError::none;
+  }
+};
+
+// Checks a file as ParseXpm2 and ParseXpm3 would without decoding it into an
+// image: the values, the colour table's syntax and names, every row's width
+// and every pixel's key. A key defined twice, whose first definition parsing
+// keeps, is reported as a warning.
+// Nothing is allocated per line or pixel; the only allocation is a key table
+// when keys are three or more characters wide.
+XpmValidation validate_xpm2(std::string_view file_contents);
+XpmValidation validate_xpm3(std::string_view file_contents);
\ No newline at end of file
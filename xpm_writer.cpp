@@ -0,0 +1,190 @@
+#include "xpm_writer.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "xpm_parse.h"
+
+void write_xpm(const XpmWriterImage& image, XpmFormat format,
+  std::string_view array_name, const XpmSink& sink)
+{
+  const bool xpm3 = format == XpmFormat::xpm3;
+  const auto chars_per_pixel = (std::size_t)image.chars_per_pixel;
+  SinkBuffer out(sink);
+
+  // Each line is quoted and escaped in XPM3, and written as is in XPM2.
+  auto write_line = [&out, xpm3](std::string_view line, bool last) {
+    if (!xpm3) {
+      out.write(line);
+      out.write("\n");
+
+      return;
+    }
+
+    out.write("\"");
+    out.write_escaped(line);
+    out.write(last ? "\"\n" : "\",\n");
+  };
+
+  if (xpm3) {
+    out.write("/* XPM */\nstatic char* ");
+    out.write(array_name);
+    out.write("_xpm[] = {\n");
+  }
+
+  else
+    out.write("! XPM2\n");
+
+  const std::string values = std::to_string(image.width) + ' ' +
+    std::to_string(image.height) + ' ' + std::to_string(image.colour_count) +
+    ' ' + std::to_string(chars_per_pixel);
+
+  write_line(values, false);
+
+  std::string keys;
+  std::string line;
+
+  keys.reserve((std::size_t)image.colour_count * chars_per_pixel);
+
+  for (auto i = 0; i < image.colour_count; i++) {
+    const std::string_view key = image.key((std::uint32_t)i);
+    const Rgba rgba = image.colour((std::uint32_t)i);
+
+    keys += key;
+    line.assign(key);
+
+    if (!rgba.a)
+      line += " c None";
+
+    else {
+      char hex[16];
+
+      std::snprintf(hex, sizeof(hex), " c #%02X%02X%02X", rgba.r & 0xff,
+        rgba.g & 0xff, rgba.b & 0xff);
+
+      line += hex;
+    }
+
+    write_line(line, false);
+  }
+
+  std::vector<std::uint32_t> indices(image.width);
+
+  line.reserve((std::size_t)image.width * chars_per_pixel);
+
+  for (auto r = 0; r < image.height; r++) {
+    image.read_row(r, indices.data());
+    line.clear();
+
+    for (const auto index : indices)
+      line.append(keys, index * chars_per_pixel, chars_per_pixel);
+
+    write_line(line, r + 1 == image.height);
+  }
+
+  if (xpm3)
+    out.write("};\n");
+
+  out.flush();
+}
+
+void write_xpm(const Xpm& xpm, XpmFormat format, std::string_view array_name,
+  const XpmSink& sink)
+{
+  const auto width = (std::size_t)xpm.width();
+  std::vector<std::uint64_t> counts(xpm.colour_count());
+
+  std::visit([&counts](const auto& indices) {
+    for (const auto index : indices)
+      counts[index]++;
+  }, xpm.indices());
+
+  // Colours are merged on their packed RGBA, with every transparent colour
+  // packed the same, then ordered by use with ties kept in palette order.
+  struct Colour {
+    Rgba rgba;
+    std::uint64_t count;
+  };
+
+  std::vector<Colour> colours;
+  std::vector<std::uint32_t> remap(xpm.colour_count());
+  std::unordered_map<std::uint32_t, std::uint32_t> colour_lookup;
+
+  for (std::uint32_t i = 0; i < counts.size(); i++) {
+    if (!counts[i])
+      continue;
+
+    Rgba rgba = xpm.palette()[i];
+
+    if (!rgba.a)
+      rgba = {};
+
+    const std::uint32_t packed = (std::uint32_t)(rgba.r & 0xff) |
+      (std::uint32_t)(rgba.g & 0xff) << 8 | (std::uint32_t)(rgba.b & 0xff) <<
+      16 | (std::uint32_t)(rgba.a & 0xff) << 24;
+
+    const auto [it, inserted] = colour_lookup.try_emplace(packed,
+      (std::uint32_t)colours.size());
+
+    if (inserted)
+      colours.push_back({ rgba, 0 });
+
+    colours[it->second].count += counts[i];
+    remap[i] = it->second;
+  }
+
+  std::vector<std::uint32_t> order(colours.size());
+
+  for (std::uint32_t i = 0; i < order.size(); i++)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(),
+    [&colours](std::uint32_t a, std::uint32_t b) {
+      return colours[a].count > colours[b].count;
+    });
+
+  std::vector<std::uint32_t> rank(colours.size());
+
+  for (std::uint32_t i = 0; i < order.size(); i++)
+    rank[order[i]] = i;
+
+  for (auto& index : remap)
+    index = rank[index];
+
+  const int chars_per_pixel = xpm_min_chars_per_pixel(colours.size());
+
+  // Keys count up from the first character, the last position fastest.
+  std::string keys(colours.size() * chars_per_pixel, xpm_key_chars[0]);
+
+  const std::size_t key_char_count = xpm_key_chars.size();
+
+  for (std::size_t i = 0; i < colours.size(); i++) {
+    std::size_t value = i;
+
+    for (auto pos = chars_per_pixel; pos-- > 0; value /= key_char_count)
+      keys[i * chars_per_pixel + pos] = xpm_key_chars[value % key_char_count];
+  }
+
+  XpmWriterImage image = {
+    xpm.width(), xpm.height(), (int)colours.size(), chars_per_pixel,
+    [&keys, chars_per_pixel](std::uint32_t index) {
+      return std::string_view(keys).substr((std::size_t)index *
+        chars_per_pixel, chars_per_pixel);
+    },
+    [&colours, &order](std::uint32_t index) {
+      return colours[order[index]].rgba;
+    },
+    [&xpm, &remap, width](int row, std::uint32_t* out) {
+      std::visit([&](const auto& indices) {
+        const auto* begin = indices.data() + (std::size_t)row * width;
+
+        for (std::size_t c = 0; c < width; c++)
+          out[c] = remap[begin[c]];
+      }, xpm.indices());
+    }
+  };
+
+  write_xpm(image, format, array_name, sink);
+}
\ No newline at end of file
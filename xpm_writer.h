@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include "rgb.h"
+#include "xpm.h"
+
+enum class XpmFormat
+{
+  xpm2,
+  xpm3,
+};
+
+// Printable characters that need no escaping in XPM3 and cannot be taken for
+// an XPM2 header or the space that separates a key from its colour.
+inline constexpr std::string_view xpm_key_chars =
+  "#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[]^_`"
+  "abcdefghijklmnopqrstuvwxyz{|}~";
+
+// The fewest chars per pixel that give colour_count keys from xpm_key_chars.
+constexpr int xpm_min_chars_per_pixel(std::uint64_t colour_count) {
+  int chars_per_pixel = 1;
+
+  for (std::uint64_t key_count = xpm_key_chars.size();
+    key_count < colour_count; key_count *= xpm_key_chars.size())
+  {
+    chars_per_pixel++;
+  }
+
+  return chars_per_pixel;
+}
+
+// What the writer needs of an image, whatever holds it. Keys and colours are
+// read once per palette entry and pixels a row of palette indices at a time.
+struct XpmWriterImage {
+  int width;
+  int height;
+  int colour_count;
+  int chars_per_pixel;
+  std::function<std::string_view(std::uint32_t index)> key;
+  std::function<Rgba(std::uint32_t index)> colour;
+  std::function<void(int row, std::uint32_t* indices)> read_row;
+};
+
+// Writes image as XPM text with a "c" colour for every palette entry: its
+// hex value, or None where it is transparent. XPM3 output declares the array
+// as array_name_xpm.
+void write_xpm(const XpmWriterImage& image, XpmFormat format,
+  std::string_view array_name, const XpmSink& sink);
+
+// Writes xpm as text rebuilt from its pixels rather than its source. Unused
+// colours are dropped and colours with the same RGBA merged, transparent ones
+// all becoming None. The palette is ordered from the most used colour down
+// and re-keyed with the fewest chars per pixel that can tell it apart.
+void write_xpm(const Xpm& xpm, XpmFormat format, std::string_view array_name,
+  const XpmSink& sink);
\ No newline at end of file